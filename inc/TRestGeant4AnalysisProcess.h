@@ -26,58 +26,107 @@
 #include <TRestGeant4Event.h>
 #include <TRestGeant4Metadata.h>
 
+#include <set>
+
 #include "TRestEventProcess.h"
 
-//! A pure analysis process to extract information from a TRestGeant4Event
-class TRestGeant4AnalysisProcess : public TRestEventProcess {
+/// A generic observable of TRestGeant4AnalysisProcess, parsed once from its name in InitProcess
+struct TRestGeant4AnalysisObservable {
+    /// The kinds are declared in the order their values are set in ProcessEvent
+    enum class Kind {
+        CONTAINS_PROCESS,  // containsProcessXxx, 1 if the event has a hit with process `xxx`
+        TRACKS_COUNTER,    // xxxTracksCounter, number of tracks of particle `xxx`
+        TRACKS_EDEP,       // xxxTracksEDep, energy deposited by the tracks of particle `xxx`
+        VOLUME_EDEP,       // xxxVolumeEDep, energy deposited in volume `xxx`
+        MEAN_POS,          // xxxMeanPosX, mean hit position in volume `xxx` along one axis
+    };
+
+    Kind kind;
+    std::string name;
+    TString volumeName;
+    TString particleName;
+    Int_t volumeID = -1;
+    Int_t particleID = -1;
+    Int_t processID = -1;
+    /// 0, 1 or 2 for X, Y or Z, or -1 if the axis is not valid (the value is always 0)
+    Int_t axis = -1;
+    /// The slot of the value in TRestGeant4AnalysisPlan, if the observable is computed by the plan
+    size_t slot = 0;
+};
+
+/// Execution plan of the per-hit and per-track observables of TRestGeant4AnalysisProcess. The volumes,
+/// particles and processes requested are registered once, and Fill computes all of them in a single pass
+/// over the tracks and hits of an event. The results are identical to the ones of the equivalent
+/// TRestGeant4Event methods (GetMeanPositionInVolume, GetNumberOfTracksForParticle, ...).
+class TRestGeant4AnalysisPlan {
    private:
-    /// A pointer to the specific TRestGeant4Event input
-    TRestGeant4Event* fInputG4Event;  //!
+    Int_t fSensitiveVolumeID = -1;
 
-    /// A pointer to the specific TRestGeant4Event output
-    TRestGeant4Event* fOutputG4Event;  //!
+    std::vector<Int_t> fMeanPositionVolumeIDs;
+    std::vector<Int_t> fMeanPositionSlotByVolumeID;
 
-    /// A pointer to the simulation metadata information accessible to TRestRun
-    TRestGeant4Metadata* fG4Metadata;  //!
+    std::vector<TString> fParticleNames;
+    std::vector<Int_t> fParticleIDs;
 
-    /// It stores the name of observables `xxxVolumeEDep` related to the energy deposition in volume `xxx`.
-    std::vector<std::string> fEnergyInObservables;  //!
+    std::vector<Int_t> fProcessIDs;
 
-    /// A std::vector storing the active volume ids of observables `xxxVolumeEDep`.
-    std::vector<Int_t> fVolumeID;  //!
+    Double_t fSensitiveVolumeFirstHitTime = 0;
+    std::set<Int_t> fTrackIDsInSensitiveVolume;
 
-    std::vector<std::string> fVolumeName;  //! A std::vector storing the name of active volumes.
+    std::vector<TVector3> fMeanPosition;
+    std::vector<Double_t> fMeanPositionEnergy;
+    std::vector<TVector3> fTrackPosition;
+    std::vector<Double_t> fTrackEnergy;
 
-    /// It stores the name of observables (xxxMeanPosX,Y,Z) related to mean hits position in volume `xxx`.
-    std::vector<std::string> fMeanPosObservables;  //!
+    std::vector<Int_t> fParticleNumberOfTracks;
+    std::vector<Double_t> fParticleEnergy;
 
-    /// A std::vector storing the active volume ids corresponding mean position observable `xxxMeanPosX,Y,Z`.
-    std::vector<Int_t> fVolumeID2;  //!
+    std::vector<Bool_t> fContainsProcess;
 
-    /// A std::vector storing the direction X,Y or Z from corresponding mean position observable
-    /// `xxxMeanPosX,Y,Z`.
-    std::vector<std::string> fDirID;  //!
+    Double_t fMinX = 0, fMaxX = 0, fMinY = 0, fMaxY = 0, fMinZ = 0, fMaxZ = 0;
 
-    /// A std::vector storing the name of observables  related to processes in a particular active volume.
-    std::vector<std::string> fProcessObservables;  //!
+    void Reset();
 
-    /// A std::vector storing the active volume ids corresponding process observable .
-    std::vector<Int_t> fVolumeID3;  //!
+   public:
+    void Clear();
+
+    inline void SetSensitiveVolumeID(Int_t volumeID) { fSensitiveVolumeID = volumeID; }
+    size_t AddMeanPositionVolume(Int_t volumeID);
+    size_t AddParticle(const TString& particleName, Int_t particleID);
+    size_t AddProcess(Int_t processID);
+
+    void Fill(const TRestGeant4Event& event);
+
+    inline Int_t GetSensitiveVolumeID() const { return fSensitiveVolumeID; }
+    /// Time of the first hit with energy in the sensitive volume, infinity if there is none
+    inline Double_t GetSensitiveVolumeFirstHitTime() const { return fSensitiveVolumeFirstHitTime; }
+    /// IDs of the tracks with at least one hit with energy in the sensitive volume
+    inline const std::set<Int_t>& GetTrackIDsInSensitiveVolume() const { return fTrackIDsInSensitiveVolume; }
+
+    TVector3 GetMeanPosition(size_t slot) const;
+    inline Int_t GetNumberOfTracks(size_t slot) const { return fParticleNumberOfTracks[slot]; }
+    inline Double_t GetEnergyDepositedByParticle(size_t slot) const { return fParticleEnergy[slot]; }
+    inline Bool_t ContainsProcess(size_t slot) const { return fContainsProcess[slot]; }
+    Double_t GetBoundingBoxSize() const;
+};
 
-    /// A std::vector storing the name of processes.
-    std::vector<std::string> fProcessName;  //!
+//! A pure analysis process to extract information from a TRestGeant4Event
+class TRestGeant4AnalysisProcess : public TRestEventProcess {
+   private:
+    /// A pointer to the specific TRestGeant4Event input
+    TRestGeant4Event* fInputG4Event;  //!
 
-    /// A std::vector storing the observable name `xxxTracksCounter` for a given `xxx` particle.
-    std::vector<std::string> fTrackCounterObservables;  //!
+    /// A pointer to the specific TRestGeant4Event output
+    TRestGeant4Event* fOutputG4Event;  //!
 
-    /// A std::vector storing the `xxx` particle name extracted from `xxxTracksCounter`.
-    std::vector<std::string> fParticleTrackCounter;  //!
+    /// A pointer to the simulation metadata information accessible to TRestRun
+    TRestGeant4Metadata* fG4Metadata;  //!
 
-    /// A std::vector storing the observable name `xxxTracksEDep` for a given `xxx` particle.
-    std::vector<std::string> fTracksEDepObservables;  //!
+    /// The generic observables (`xxxVolumeEDep`, `xxxMeanPosX`, ...) parsed in InitProcess.
+    std::vector<TRestGeant4AnalysisObservable> fGenericObservables;  //!
 
-    /// A std::vector storing the `xxx` particle name extracted from `xxxTracksEDep`.
-    std::vector<std::string> fParticleTrackEdep;  //!
+    /// Single pass execution plan of the observables, built in InitProcess.
+    TRestGeant4AnalysisPlan fPlan;  //!
 
     Bool_t fPerProcessSensitiveEnergy = false;
     Bool_t fPerProcessSensitiveEnergyNorm = false;
@@ -86,6 +135,9 @@ class TRestGeant4AnalysisProcess : public TRestEventProcess {
 
     void LoadDefaultConfig();
 
+    bool ParseObservable(const std::string& observableName, TRestGeant4AnalysisObservable& observable);
+    void BuildPlan();
+
    protected:
     // add here the members of your event process
 
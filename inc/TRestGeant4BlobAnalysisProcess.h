@@ -17,8 +17,30 @@
 
 #include "TRestEventProcess.h"
 
+/// A blob found by TRestGeant4BlobAnalysisProcess in "clusters" mode
+struct TRestGeant4Blob {
+    /// Energy weighted position of the hits in the blob
+    TVector3 position;
+    /// Energy of the hits in the blob
+    Double_t energy = 0;
+    /// Energy weighted RMS distance of the hits in the blob to its position
+    Double_t extent = 0;
+    /// Index of the cluster of connected voxels that contains the blob
+    Int_t cluster = -1;
+};
+
 class TRestGeant4BlobAnalysisProcess : public TRestEventProcess {
    private:
+    /// "electrons" (default) takes the end of the two primary electrons as blobs. "clusters" finds the
+    /// fNumberOfBlobs densest regions of the event, see FindBlobs
+    std::string fBlobMode = "electrons";
+    /// Number of blobs searched in "clusters" mode
+    Int_t fNumberOfBlobs = 2;
+    /// Size (mm) of the voxels used to cluster the hits in "clusters" mode
+    Double_t fVoxelSize = 1;
+    /// Hits below this energy (keV) are ignored in "clusters" mode
+    Double_t fMinimumHitEnergy = 0;
+
 #ifndef __CINT__
     TRestGeant4Event* fG4Event;        //!
     TRestGeant4Metadata* fG4Metadata;  //!
@@ -28,6 +50,9 @@ class TRestGeant4BlobAnalysisProcess : public TRestEventProcess {
 
     std::vector<std::string> fQ2_Observables;  //!
     std::vector<double> fQ2_Radius;            //!
+
+    /// Observable names of each blob in "clusters" mode: x, y, z, energy and extent
+    std::vector<std::vector<std::string>> fBlobObservables;  //!
 #endif
 
     void InitFromConfigFile() override;
@@ -49,9 +74,18 @@ class TRestGeant4BlobAnalysisProcess : public TRestEventProcess {
 
     void LoadConfig(const std::string& configFilename, const std::string& name = "");
 
+    std::vector<TRestGeant4Blob> FindBlobs(const TRestGeant4Event& event, Int_t& numberOfClusters) const;
+
     void PrintMetadata() override {
         BeginPrintProcess();
 
+        RESTMetadata << "Blob mode : " << fBlobMode << RESTendl;
+        if (fBlobMode == "clusters") {
+            RESTMetadata << "Number of blobs : " << fNumberOfBlobs << RESTendl;
+            RESTMetadata << "Voxel size : " << fVoxelSize << " mm" << RESTendl;
+            RESTMetadata << "Minimum hit energy : " << fMinimumHitEnergy << " keV" << RESTendl;
+        }
+
         EndPrintProcess();
     }
 
@@ -63,7 +97,7 @@ class TRestGeant4BlobAnalysisProcess : public TRestEventProcess {
     // Destructor
     ~TRestGeant4BlobAnalysisProcess();
 
-    ClassDefOverride(TRestGeant4BlobAnalysisProcess, 1);  // Template for a REST "event process" class
+    ClassDefOverride(TRestGeant4BlobAnalysisProcess, 2);  // Template for a REST "event process" class
                                                           // inherited from TRestEventProcess
 };
 #endif
@@ -34,15 +34,167 @@
 
 #include <iostream>
 #include <map>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 
 #include "TRestGeant4Track.h"
 
+class TBranch;
+class TTree;
 class G4Event;
 class G4Track;
 class G4Step;
 class TRestGeant4Metadata;
 
+/// Event-wide hit store in structure-of-arrays layout. The hits of the track with index `i` occupy the
+/// range [fTrackOffsets[i], fTrackOffsets[i + 1]) of every attribute array.
+struct TRestGeant4HitsColumns {
+    std::vector<Float_t> fX;
+    std::vector<Float_t> fY;
+    std::vector<Float_t> fZ;
+    std::vector<Float_t> fTime;
+    std::vector<Float_t> fEnergy;
+    std::vector<Float_t> fKineticEnergy;
+    std::vector<Int_t> fProcessID;
+    std::vector<Int_t> fVolumeID;
+    std::vector<Double_t> fMomentumDirectionX;
+    std::vector<Double_t> fMomentumDirectionY;
+    std::vector<Double_t> fMomentumDirectionZ;
+
+    std::vector<size_t> fTrackOffsets;
+
+    inline size_t GetNumberOfHits() const { return fEnergy.size(); }
+    inline size_t GetNumberOfTracks() const { return fTrackOffsets.empty() ? 0 : fTrackOffsets.size() - 1; }
+    inline size_t GetTrackBegin(size_t trackIndex) const { return fTrackOffsets[trackIndex]; }
+    inline size_t GetTrackEnd(size_t trackIndex) const { return fTrackOffsets[trackIndex + 1]; }
+    inline bool IsEmpty() const { return fTrackOffsets.empty(); }
+
+    void Clear();
+    void Reserve(size_t numberOfHits, size_t numberOfTracks);
+};
+
+/// Reference to a single hit of a TRestGeant4Event, given by its track and its position in the track hits
+class TRestGeant4HitRef {
+   private:
+    const TRestGeant4Track* fTrack = nullptr;
+    size_t fHitIndex = 0;
+
+   public:
+    inline const TRestGeant4Track& GetTrack() const { return *fTrack; }
+    inline size_t GetHitIndex() const { return fHitIndex; }
+
+    inline Double_t GetX() const { return fTrack->GetHits().GetX(fHitIndex); }
+    inline Double_t GetY() const { return fTrack->GetHits().GetY(fHitIndex); }
+    inline Double_t GetZ() const { return fTrack->GetHits().GetZ(fHitIndex); }
+    inline TVector3 GetPosition() const { return {GetX(), GetY(), GetZ()}; }
+    inline Double_t GetEnergy() const { return fTrack->GetHits().GetEnergy(fHitIndex); }
+    inline Double_t GetTime() const { return fTrack->GetHits().GetTime(fHitIndex); }
+    inline Int_t GetVolumeID() const { return fTrack->GetHits().GetVolumeId(fHitIndex); }
+    inline Int_t GetProcessID() const { return fTrack->GetHits().GetProcessId(fHitIndex); }
+
+    TRestGeant4HitRef(const TRestGeant4Track* track, size_t hitIndex) : fTrack(track), fHitIndex(hitIndex) {}
+};
+
+/// Non-owning range over the hits of a TRestGeant4Event, optionally filtered by volume, minimum energy
+/// and process. It reads the hits stored in the tracks and becomes invalid if the event tracks change.
+///
+/// \code
+/// for (const auto& hit : event->GetHitsView(volumeID)) {
+///     energy += hit.GetEnergy();
+/// }
+/// \endcode
+class TRestGeant4HitsView {
+   private:
+    const std::vector<TRestGeant4Track>* fTracks = nullptr;
+    Int_t fVolumeID = -1;
+    Double_t fMinEnergy = 0;
+    Int_t fProcessID = -1;
+
+    inline bool Accepts(const TRestGeant4Hits& hits, size_t n) const {
+        return (fVolumeID == -1 || hits.GetVolumeId(n) == fVolumeID) && hits.GetEnergy(n) >= fMinEnergy &&
+               (fProcessID == -1 || hits.GetProcessId(n) == fProcessID);
+    }
+
+   public:
+    class Iterator {
+       private:
+        const TRestGeant4HitsView* fView = nullptr;
+        size_t fTrackIndex = 0;
+        size_t fHitIndex = 0;
+
+        /// Moves forward until the current position is an accepted hit or the end of the event
+        inline void SkipRejected() {
+            const auto& tracks = *fView->fTracks;
+            while (fTrackIndex < tracks.size()) {
+                const auto& hits = tracks[fTrackIndex].GetHits();
+                for (; fHitIndex < hits.GetNumberOfHits(); fHitIndex++) {
+                    if (fView->Accepts(hits, fHitIndex)) {
+                        return;
+                    }
+                }
+                fTrackIndex++;
+                fHitIndex = 0;
+            }
+        }
+
+       public:
+        inline TRestGeant4HitRef operator*() const {
+            return {&(*fView->fTracks)[fTrackIndex], fHitIndex};
+        }
+        inline Iterator& operator++() {
+            fHitIndex++;
+            SkipRejected();
+            return *this;
+        }
+        inline bool operator==(const Iterator& other) const {
+            return fTrackIndex == other.fTrackIndex && fHitIndex == other.fHitIndex;
+        }
+        inline bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+        Iterator(const TRestGeant4HitsView* view, size_t trackIndex) : fView(view), fTrackIndex(trackIndex) {
+            SkipRejected();
+        }
+    };
+
+    inline Iterator begin() const { return {this, 0}; }
+    inline Iterator end() const { return {this, fTracks->size()}; }
+
+    size_t GetNumberOfHits() const;
+    Double_t GetTotalEnergy() const;
+    Double_t GetEnergyInSphere(Double_t x, Double_t y, Double_t z, Double_t radius) const;
+    std::vector<Double_t> GetEnergyInSpheres(Double_t x, Double_t y, Double_t z,
+                                             const std::vector<Double_t>& radii) const;
+
+    TRestGeant4HitsView(const std::vector<TRestGeant4Track>& tracks, Int_t volumeID = -1,
+                        Double_t minEnergy = 0, Int_t processID = -1)
+        : fTracks(&tracks), fVolumeID(volumeID), fMinEnergy(minEnergy), fProcessID(processID) {}
+};
+
+/// The hits of a TRestGeant4Event produced by a given process, as (track index, hit index) pairs sorted
+/// by track and hit. It points to the index kept by the event, see TRestGeant4Event::GetProcessOccurrences.
+///
+/// \code
+/// for (const auto& [trackIndex, hitIndex] : event->GetProcessOccurrences(captureID)) {
+///     const auto& track = event->GetTrack(trackIndex);
+/// }
+/// \endcode
+class TRestGeant4ProcessOccurrences {
+   private:
+    const std::pair<Int_t, Int_t>* fBegin = nullptr;
+    const std::pair<Int_t, Int_t>* fEnd = nullptr;
+
+   public:
+    inline const std::pair<Int_t, Int_t>* begin() const { return fBegin; }
+    inline const std::pair<Int_t, Int_t>* end() const { return fEnd; }
+    inline size_t size() const { return fEnd - fBegin; }
+    inline bool empty() const { return fBegin == fEnd; }
+
+    TRestGeant4ProcessOccurrences() = default;
+    TRestGeant4ProcessOccurrences(const std::pair<Int_t, Int_t>* begin, const std::pair<Int_t, Int_t>* end)
+        : fBegin(begin), fEnd(end) {}
+};
+
 /// An event class to store geant4 generated event information
 class TRestGeant4Event : public TRestEvent {
    private:
@@ -53,6 +205,76 @@ class TRestGeant4Event : public TRestEvent {
     Double_t fMinEnergy, fMaxEnergy;  //!
 #endif
 
+    TRestGeant4HitsColumns fHitsColumns;  //!
+
+    /// Energy deposited in each volume indexed by its ID in TRestGeant4GeometryInfo. Built on first use.
+    mutable std::vector<Double_t> fEnergyInVolumeIndex;  //!
+    mutable Bool_t fEnergyInVolumeIndexValid = false;    //!
+
+    /// Metadata of the run this event belongs to, resolved once in InitializeReferences
+    const TRestGeant4Metadata* fGeant4Metadata = nullptr;  //!
+
+    /// Track index for each track ID, stored at position (trackID - fLowestTrackID). -1 if not present
+    mutable std::vector<Int_t> fTrackIndexByID;  //!
+    /// Used instead of fTrackIndexByID when the track IDs are too sparse for a dense index
+    mutable std::unordered_map<Int_t, Int_t> fTrackIndexByIDSparse;  //!
+    mutable Int_t fLowestTrackID = 0;                                 //!
+    mutable Bool_t fTrackIndexIsSparse = false;                       //!
+    /// Number of tracks (from the beginning of fTracks) already present in the track ID index
+    mutable size_t fNumberOfIndexedTracks = 0;  //!
+
+    /// Genealogy of the tracks, built on first use. Indices refer to positions in fTracks
+    mutable std::vector<Int_t> fParentTrackIndex;  //!
+    mutable std::vector<Int_t> fTrackDepth;        //!
+    mutable std::vector<Int_t> fTrackPreOrder;     //!
+    mutable std::vector<Int_t> fTrackPostOrder;    //!
+    mutable std::vector<Int_t> fTracksInPreOrder;  //!
+    mutable Bool_t fGenealogyValid = false;        //!
+
+    void BuildGenealogy() const;
+    inline void UpdateGenealogy() const {
+        if (!fGenealogyValid || fParentTrackIndex.size() != fTracks.size()) {
+            BuildGenealogy();
+        }
+    }
+
+    /// Hits of each process ID, built on first use. The hits of process `id` are the range
+    /// [fProcessOccurrenceOffsets[id], fProcessOccurrenceOffsets[id + 1]) of fProcessOccurrences
+    mutable std::vector<size_t> fProcessOccurrenceOffsets;             //!
+    mutable std::vector<std::pair<Int_t, Int_t>> fProcessOccurrences;  //!
+    mutable Bool_t fProcessOccurrencesValid = false;                   //!
+
+    void BuildProcessOccurrences() const;
+
+    /// How the hits are read from the event tree, see SetHitsLazyLoading and SetHitsColumnsOnRead. It
+    /// belongs to the event object and not to its contents: assigning an event keeps the settings (and
+    /// the bound branches) of the destination, and only reads the hits still pending in the source.
+    class HitsReading {
+       public:
+        TRestGeant4Event* fOwner = nullptr;
+        Bool_t fLazyLoading = false;
+        Bool_t fColumnsOnRead = false;
+        TTree* fTree = nullptr;
+        std::vector<TBranch*> fBranches;
+        Long64_t fEntry = -1;
+        mutable Bool_t fPending = false;
+
+        HitsReading(TRestGeant4Event* owner) : fOwner(owner) {}
+        HitsReading(const HitsReading&) = delete;
+        HitsReading& operator=(const HitsReading& reading);
+    };
+
+    void BindHitsBranches(TTree* tree);
+    void LinkTracks();
+
+    Int_t GetParticleIDFromName(const TString& particleName) const;
+
+    void ResetTrackIDIndex() const;
+    void UpdateTrackIDIndex() const;
+    void AddTrackToIDIndex(Int_t trackID, Int_t trackIndex) const;
+
+    void BuildEnergyInVolumeIndex() const;
+
     void AddEnergyDepositToVolume(Int_t volID, Double_t eDep);
 
    protected:
@@ -126,10 +348,24 @@ class TRestGeant4Event : public TRestEvent {
     std::vector<Int_t> fVolumeStored;
     std::vector<std::string> fVolumeStoredNames;
     std::vector<Double_t> fVolumeDepositedEnergy;
+
+    /// Energy deposits, one entry per (volume, particle, process) combination. Volume IDs are the ones
+    /// defined in TRestGeant4GeometryInfo, particle and process IDs the ones in TRestGeant4PhysicsInfo.
+    std::vector<Int_t> fEnergyDepositVolumeID;
+    std::vector<Int_t> fEnergyDepositParticleID;
+    std::vector<Int_t> fEnergyDepositProcessID;
+    std::vector<Double_t> fEnergyDeposit;
+
+    /// Name keyed energy deposits. Only filled in files written before version 10, or when the names could
+    /// not be resolved into IDs. It is converted into the ID arrays by InitializeReferences.
     std::map<std::string, std::map<std::string, std::map<std::string, double>>>
         fEnergyInVolumePerParticlePerProcess;
     std::vector<TRestGeant4Track> fTracks;
 
+   private:
+    /// Declared after fTracks, its assignment relinks the tracks copied by the default operator=
+    HitsReading fHitsReading{this};  //!
+
    public:
     void SetBoundaries();
     void SetBoundaries(Double_t xMin, Double_t xMax, Double_t yMin, Double_t yMax, Double_t zMin,
@@ -162,9 +398,45 @@ class TRestGeant4Event : public TRestEvent {
 
     inline Int_t isVolumeStored(int n) const { return fVolumeStored[n]; }
     inline const TRestGeant4Track& GetTrack(int n) const { return fTracks[n]; }
-    inline TRestGeant4Track* GetTrackPointer(int n) { return &fTracks[n]; }
+    /// Gives write access to a track. The hits columns are dropped, see BuildHitsColumns
+    inline TRestGeant4Track* GetTrackPointer(int n) {
+        fHitsColumns.Clear();
+        return &fTracks[n];
+    }
     TRestGeant4Track* GetTrackByID(Int_t trackID) const;
 
+    /// Index of the parent of track `n` in the track list, -1 if the parent is not in the event
+    inline Int_t GetParentTrackIndex(size_t n) const {
+        UpdateGenealogy();
+        return fParentTrackIndex[n];
+    }
+    /// Number of ancestors of track `n` stored in the event, 0 for primaries
+    inline Int_t GetTrackDepth(size_t n) const {
+        UpdateGenealogy();
+        return fTrackDepth[n];
+    }
+    /// Position of track `n` in a depth-first (pre-order) traversal of the track tree
+    inline Int_t GetTrackPreOrder(size_t n) const {
+        UpdateGenealogy();
+        return fTrackPreOrder[n];
+    }
+    /// Pre-order position one past the last descendant of track `n`
+    inline Int_t GetTrackPostOrder(size_t n) const {
+        UpdateGenealogy();
+        return fTrackPostOrder[n];
+    }
+    /// Track indices sorted in pre-order, the subtree of track `n` is the range [pre(n), post(n))
+    inline const std::vector<Int_t>& GetTracksInPreOrder() const {
+        UpdateGenealogy();
+        return fTracksInPreOrder;
+    }
+    /// Returns true if track `n` is `ancestor` or one of its descendants
+    inline Bool_t IsTrackInSubtree(size_t n, size_t ancestor) const {
+        UpdateGenealogy();
+        return fTrackPreOrder[ancestor] <= fTrackPreOrder[n] && fTrackPreOrder[n] < fTrackPostOrder[ancestor];
+    }
+    Double_t GetEnergyInVolumeInSubtree(size_t n, Int_t volumeID) const;
+
     inline Double_t GetTotalDepositedEnergy() const { return fTotalDepositedEnergy; }
 
     inline Double_t GetSensitiveVolumeEnergy() const { return fSensitiveVolumeEnergy; }
@@ -181,20 +453,57 @@ class TRestGeant4Event : public TRestEvent {
     std::map<std::string, double> GetEnergyPerParticleMap() const;
     std::map<std::string, double> GetEnergyInVolumeMap() const;
 
-    inline Double_t GetEnergyInVolume(const std::string& volumeName) const {
-        auto energyMap = GetEnergyInVolumeMap();
-        return energyMap[volumeName];
-    }
+    inline size_t GetNumberOfEnergyDeposits() const { return fEnergyDeposit.size(); }
+    inline Int_t GetEnergyDepositVolumeID(size_t n) const { return fEnergyDepositVolumeID[n]; }
+    inline Int_t GetEnergyDepositParticleID(size_t n) const { return fEnergyDepositParticleID[n]; }
+    inline Int_t GetEnergyDepositProcessID(size_t n) const { return fEnergyDepositProcessID[n]; }
+    inline Double_t GetEnergyDeposit(size_t n) const { return fEnergyDeposit[n]; }
+
+    Double_t GetEnergyInVolume(const std::string& volumeName) const;
+    Double_t GetEnergyInVolume(Int_t volumeID) const;
+
+    inline void InvalidateEnergyInVolumeIndex() { fEnergyInVolumeIndexValid = false; }
+
+    TRestGeant4ProcessOccurrences GetProcessOccurrences(Int_t processID) const;
+    inline void InvalidateProcessOccurrences() { fProcessOccurrencesValid = false; }
 
     std::pair<double, double> GetTimeRangeOfIonizationInVolume(const std::string& volumeName) const;
 
-    inline void ClearTracks() { fTracks.clear(); }
+    inline void ClearTracks() {
+        fTracks.clear();
+        fHitsColumns.Clear();
+        ResetTrackIDIndex();
+        fGenealogyValid = false;
+        fProcessOccurrencesValid = false;
+    }
+
+    void BuildHitsColumns();
+    inline void ClearHitsColumns() { fHitsColumns.Clear(); }
+    inline bool HasHitsColumns() const { return !fHitsColumns.IsEmpty(); }
+    inline const TRestGeant4HitsColumns& GetHitsColumns() const { return fHitsColumns; }
+    /// If enabled, the hits columns are built each time an entry is read (see InitializeReferences)
+    inline void SetHitsColumnsOnRead(Bool_t enable = true) { fHitsReading.fColumnsOnRead = enable; }
+    inline Bool_t IsHitsColumnsOnRead() const { return fHitsReading.fColumnsOnRead; }
+
+    void SetHitsLazyLoading(Bool_t enable = true);
+    inline Bool_t IsHitsLazyLoading() const { return fHitsReading.fLazyLoading; }
+    void LoadHits() const;
+
+    Bool_t CompactHits(Int_t positionMantissaBits = 23, Int_t timeMantissaBits = 23);
 
     TRestHits GetHits(Int_t volID = -1) const;
+    /// Returns a view over the hits of the event, without copying them. `-1` disables the volume and
+    /// process filters
+    inline TRestGeant4HitsView GetHitsView(Int_t volID = -1, Double_t minEnergy = 0,
+                                           Int_t processID = -1) const {
+        return {fTracks, volID, minEnergy, processID};
+    }
     inline TRestHits GetHitsInVolume(Int_t volID) const { return GetHits(volID); }
 
     Int_t GetNumberOfTracksForParticle(const TString& particleName) const;
+    Int_t GetNumberOfTracksForParticle(Int_t particleID) const;
     Double_t GetEnergyDepositedByParticle(const TString& particleName) const;
+    Double_t GetEnergyDepositedByParticle(Int_t particleID) const;
 
     inline void ActivateVolumeForStorage(Int_t n) { fVolumeStored[n] = 1; }
     inline void DisableVolumeForStorage(Int_t n) { fVolumeStored[n] = 0; }
@@ -233,7 +542,9 @@ class TRestGeant4Event : public TRestEvent {
     }
 
     Bool_t ContainsParticle(const TString& particleName) const;
+    Bool_t ContainsParticle(Int_t particleID) const;
     Bool_t ContainsParticleInVolume(const TString& particleName, Int_t volumeID = -1) const;
+    Bool_t ContainsParticleInVolume(Int_t particleID, Int_t volumeID = -1) const;
 
     void Initialize() override;
 
@@ -241,6 +552,18 @@ class TRestGeant4Event : public TRestEvent {
 
     const TRestGeant4Metadata* GetGeant4Metadata() const;
 
+    // Used to build events outside restG4 and without a run (e.g. in the tests)
+    void SetGeant4Metadata(const TRestGeant4Metadata* metadata);
+    inline void SetPrimaryEventOrigin(const TVector3& position) { fPrimaryPosition = position; }
+    void AddPrimaryParticle(const TString& particleName, Double_t energy, const TVector3& direction);
+    void AddTrack(const TRestGeant4Track& track);
+    void AddEnergyInVolumeForParticleForProcess(Double_t energy, const std::string& volumeName,
+                                                const std::string& particleName,
+                                                const std::string& processName,
+                                                const TRestGeant4Metadata* metadata = nullptr);
+    void AddEnergyInVolumeForParticleForProcess(Double_t energy, Int_t volumeID, Int_t particleID,
+                                                Int_t processID);
+
     /// maxTracks : number of tracks to print, 0 = all
     void PrintActiveVolumes() const;
     void PrintEvent(int maxTracks = 0, int maxHits = 0) const;
@@ -251,11 +574,18 @@ class TRestGeant4Event : public TRestEvent {
 
     // Constructor
     TRestGeant4Event();
+    TRestGeant4Event(const TRestGeant4Event& event);
+    TRestGeant4Event& operator=(const TRestGeant4Event& event) = default;
 
     // Destructor
     virtual ~TRestGeant4Event();
 
-    ClassDefOverride(TRestGeant4Event, 9);  // REST event superclass
+    // Schema evolution:
+    // - version 10: energy deposits stored as ID arrays, older files only have the name keyed map, which is
+    //   converted on read (ConvertLegacyEnergyDeposits)
+    // - version 11: fTrackIDToTrackIndex is transient, the track ID index is rebuilt on read. The member
+    //   stored in older files is skipped by ROOT, no read rule is needed
+    ClassDefOverride(TRestGeant4Event, 11);  // REST event superclass
 
     // restG4
    public:
@@ -268,11 +598,39 @@ class TRestGeant4Event : public TRestEvent {
     friend class TRestGeant4QuenchingProcess;
 
    private:
-    std::map<Int_t, Int_t> fTrackIDToTrackIndex = {};
-    TRestGeant4Hits fInitialStep;  //!
+    /// \deprecated Still written by the restG4 OutputManager, but no longer read: GetTrackByID uses the
+    /// transient track ID index. Transient since version 11, remove it once restG4 stops filling it.
+    std::map<Int_t, Int_t> fTrackIDToTrackIndex = {};  //!
+    TRestGeant4Hits fInitialStep;                      //!
+
+    using EnergyDepositKey = std::tuple<Int_t, Int_t, Int_t>;  // volume, particle and process IDs
+    struct EnergyDepositKeyHash {
+        size_t operator()(const EnergyDepositKey& key) const {
+            // the IDs are small non negative integers, 21 bits each are enough to keep them apart
+            return std::hash<ULong64_t>()((ULong64_t(UInt_t(std::get<0>(key))) << 42) ^
+                                          (ULong64_t(UInt_t(std::get<1>(key))) << 21) ^
+                                          ULong64_t(UInt_t(std::get<2>(key))));
+        }
+    };
 
-    void AddEnergyInVolumeForParticleForProcess(Double_t energy, const std::string& volumeName,
-                                                const std::string& particleName,
-                                                const std::string& processName);
+    /// Position of each (volume, particle, process) combination in the energy deposit arrays
+    std::unordered_map<EnergyDepositKey, size_t, EnergyDepositKeyHash> fEnergyDepositLookup;  //!
+
+    /// IDs of the names already translated by the name overload of AddEnergyInVolumeForParticleForProcess,
+    /// valid for the metadata they were translated with
+    const TRestGeant4Metadata* fEnergyDepositNamesMetadata = nullptr;  //!
+    std::unordered_map<std::string, Int_t> fEnergyDepositVolumeIDs;    //!
+    std::unordered_map<std::string, Int_t> fEnergyDepositParticleIDs;  //!
+    std::unordered_map<std::string, Int_t> fEnergyDepositProcessIDs;   //!
+
+    /// Same as GetGeant4Metadata, but silently returning nullptr when the event has no metadata
+    inline const TRestGeant4Metadata* FindGeant4Metadata() const {
+        return fGeant4Metadata != nullptr || fRun != nullptr ? GetGeant4Metadata() : nullptr;
+    }
+
+    void AddEnergyDeposit(Double_t energy, Int_t volumeID, Int_t particleID, Int_t processID);
+    void ClearEnergyDepositArrays();
+    void ClearEnergyDeposits();
+    void ConvertLegacyEnergyDeposits();
 };
 #endif
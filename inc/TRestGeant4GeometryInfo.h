@@ -6,12 +6,85 @@
 #include <TString.h>
 #include <TVector3.h>
 
+#include <atomic>
+#include <list>
 #include <map>
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class G4VPhysicalVolume;
 
+/// Replaces, in a single left to right scan, every occurrence of a set of patterns by its replacement. At
+/// each position the longest pattern starting there is replaced, and the scan continues after it. Patterns
+/// are stored in a prefix trie, so translating a string costs O(length x longest pattern), independently
+/// of the number of patterns.
+class TRestGeant4PathTranslator {
+   private:
+    struct Node {
+        std::map<char, Int_t> children;
+        Int_t replacement = -1;
+    };
+    std::vector<Node> fNodes = {Node()};
+    std::vector<std::string> fReplacements;
+
+   public:
+    inline void Clear() {
+        fNodes = {Node()};
+        fReplacements.clear();
+    }
+    inline bool IsEmpty() const { return fReplacements.empty(); }
+
+    void Insert(const std::string& pattern, const std::string& replacement);
+    std::string Translate(const std::string& input) const;
+};
+
+/// Least recently used memo of translated paths. A copy starts empty, so that it never refers to the
+/// entries of the memo it was copied from.
+class TRestGeant4PathMemo {
+   private:
+    std::list<std::pair<std::string, TString>> fEntries;
+    std::unordered_map<std::string, std::list<std::pair<std::string, TString>>::iterator> fIndex;
+    size_t fCapacity = 4096;
+
+   public:
+    inline void Clear() {
+        fEntries.clear();
+        fIndex.clear();
+    }
+
+    const TString* Find(const std::string& path);
+    void Insert(const std::string& path, const TString& translation);
+
+    TRestGeant4PathMemo() = default;
+    TRestGeant4PathMemo(const TRestGeant4PathMemo& memo) : fCapacity(memo.fCapacity) {}
+    inline TRestGeant4PathMemo& operator=(const TRestGeant4PathMemo& memo) {
+        Clear();
+        fCapacity = memo.fCapacity;
+        return *this;
+    }
+};
+
+/// Validity flag of lazily built transient indices, which may be checked from several threads. A copy takes
+/// the value of the flag it is copied from, since the indices are copied along with it.
+class TRestGeant4IndexFlag {
+   private:
+    std::atomic<bool> fValid{false};
+
+   public:
+    inline bool IsValid() const { return fValid.load(std::memory_order_acquire); }
+    inline void Set(bool valid) { fValid.store(valid, std::memory_order_release); }
+
+    TRestGeant4IndexFlag() = default;
+    TRestGeant4IndexFlag(const TRestGeant4IndexFlag& flag) : fValid(flag.IsValid()) {}
+    inline TRestGeant4IndexFlag& operator=(const TRestGeant4IndexFlag& flag) {
+        Set(flag.IsValid());
+        return *this;
+    }
+};
+
 class TRestGeant4GeometryInfo {
     ClassDef(TRestGeant4GeometryInfo, 4);
 
@@ -22,12 +95,43 @@ class TRestGeant4GeometryInfo {
     std::map<Int_t, TString> fVolumeNameMap = {};
     std::map<TString, Int_t> fVolumeNameReverseMap = {};
 
+    /// Transient hash indices backing the name lookups. They are built together on first use (e.g. after
+    /// reading from a file), under a lock since lookups may come from Geant4 worker threads, and dropped
+    /// by InvalidateIndices.
+    /// Geant4 physical name -> alternative names, in fNewPhysicalToGeant4PhysicalNameMap order
+    mutable std::unordered_map<std::string, std::vector<TString>> fAlternativeNamesIndex;  //!
+    /// Names of fGdmlNewPhysicalNames
+    mutable std::unordered_set<std::string> fGdmlNamesIndex;  //!
+    mutable TRestGeant4IndexFlag fNameIndicesValid;           //!
+
+    void BuildNameIndices() const;
+    void UpdateNameIndices() const;
+    const std::vector<TString>* FindAlternativeNames(const TString& geant4PhysicalName) const;
+
+    /// Translators of GetAlternativePathFromGeant4Path, built on demand from the assembly maps: assembly
+    /// imprints to GDML names, then assembly children to GDML physical names. Like the name indices, they
+    /// are built under a lock and dropped by InvalidateIndices. The memo is guarded by its own lock.
+    mutable TRestGeant4PathTranslator fImprintTranslator;   //!
+    mutable TRestGeant4PathTranslator fChildrenTranslator;  //!
+    mutable TRestGeant4IndexFlag fPathTranslatorsValid;     //!
+    mutable TRestGeant4PathMemo fTranslatedPaths;           //!
+
+    void BuildPathTranslators() const;
+    void UpdatePathTranslators() const;
+
+    bool LoadFromGdmlCache(const TString& cacheFilename);
+    void SaveToGdmlCache(const TString& cacheFilename) const;
+
     void PopulateFromGeant4World(const G4VPhysicalVolume*);
 
     inline void InitializeOnDetectorConstruction(const TString& gdmlFilename,
                                                  const G4VPhysicalVolume* world) {
         PopulateFromGdml(gdmlFilename);
         PopulateFromGeant4World(world);
+        // the maps are complete, the indices are built before the Geant4 worker threads use them
+        InvalidateIndices();
+        UpdateNameIndices();
+        UpdatePathTranslators();
     }
 
    public:
@@ -72,6 +176,10 @@ class TRestGeant4GeometryInfo {
 
     void PopulateFromGdml(const TString&);
 
+    /// \brief Drops the transient indices of the lookups by name. It must be called after modifying the
+    /// volume name maps once they have been used.
+    void InvalidateIndices();
+
     TString GetAlternativePathFromGeant4Path(const TString&) const;
     TString GetAlternativeNameFromGeant4PhysicalName(const TString&) const;
     std::set<TString> GetAlternativeNamesFromGeant4PhysicalName(const TString&) const;
@@ -84,14 +192,7 @@ class TRestGeant4GeometryInfo {
     std::vector<TString> GetAllLogicalVolumesMatchingExpression(const TString&) const;
     std::vector<TString> GetAllPhysicalVolumesMatchingExpression(const TString&) const;
 
-    inline bool IsValidGdmlName(const TString& volume) const {
-        for (const auto& name : fGdmlNewPhysicalNames) {
-            if (name == volume) {
-                return true;
-            }
-        }
-        return false;
-    }
+    bool IsValidGdmlName(const TString& volume) const;
 
     /// \brief Checks if a (Geant4) physical volume name exists in the geometry.
     inline bool IsValidGeant4PhysicalVolume(const TString& volume) const {
@@ -110,8 +211,9 @@ class TRestGeant4GeometryInfo {
 
     /// \brief Gets all the (Geant4) physical volume names corresponding to a given logical volume name.
     inline std::vector<TString> GetAllPhysicalVolumesFromLogical(const TString& logicalVolume) const {
-        if (IsValidLogicalVolume(logicalVolume)) {
-            return fLogicalToPhysicalMap.at(logicalVolume);
+        const auto it = fLogicalToPhysicalMap.find(logicalVolume);
+        if (it != fLogicalToPhysicalMap.end()) {
+            return it->second;
         }
         return {};
     }
@@ -123,12 +225,26 @@ class TRestGeant4GeometryInfo {
 
     inline bool IsAssembly() const { return fIsAssembly; }
     inline TString GetPathSeparator() const { return fPathSeparator; }
-    void SetPathSeparator(const TString& separator) { fPathSeparator = separator; }
+    void SetPathSeparator(const TString& separator) {
+        fPathSeparator = separator;
+        InvalidateIndices();
+    }
     void InsertVolumeName(Int_t id, const TString& volumeName);
 
+    /// \brief Checks if a volume name has been assigned an ID.
+    inline bool HasVolumeID(const TString& volumeName) const {
+        return fVolumeNameReverseMap.count(volumeName) > 0;
+    }
+
     TString GetVolumeFromID(Int_t id) const;
     Int_t GetIDFromVolume(const TString& volumeName) const;
 
+    /// Same as GetIDFromVolume, but silently returning -1 for unknown volumes
+    inline Int_t FindIDFromVolume(const TString& volumeName) const {
+        const auto it = fVolumeNameReverseMap.find(volumeName);
+        return it != fVolumeNameReverseMap.end() ? it->second : -1;
+    }
+
     void Print(bool multiLine = false) const;
 
     friend class DetectorConstruction;
@@ -35,6 +35,12 @@ class TRestGeant4Hits : public TRestHits {
     std::vector<Float_t> fKineticEnergy = {};
     std::vector<TVector3> fMomentumDirection = {};
 
+    /// Compact storage written by Compact(), the full size members above are left empty in that case
+    std::vector<UShort_t> fProcessIDCompact = {};
+    std::vector<UShort_t> fVolumeIDCompact = {};
+    /// Two octahedral-encoded 16 bit values per hit
+    std::vector<UShort_t> fMomentumDirectionCompact = {};
+
     std::vector<std::string> fHadronicTargetIsotopeName = {};
     std::vector<int> fHadronicTargetIsotopeA = {};
     std::vector<int> fHadronicTargetIsotopeZ = {};
@@ -42,8 +48,13 @@ class TRestGeant4Hits : public TRestHits {
     TRestGeant4Track* fTrack = nullptr;  //!
     TRestGeant4Event* fEvent = nullptr;  //!
 
+    const TRestGeant4Metadata* fGeant4Metadata = nullptr;  //!
+
+    void ClearEventHitsColumns();
+
    public:
     TRestGeant4Metadata* GetGeant4Metadata() const;
+    inline void SetGeant4Metadata(const TRestGeant4Metadata* metadata) { fGeant4Metadata = metadata; }
 
     inline const TRestGeant4Track* GetTrack() const { return fTrack; }
     inline void SetTrack(TRestGeant4Track* track) { fTrack = track; }
@@ -51,23 +62,35 @@ class TRestGeant4Hits : public TRestHits {
     inline const TRestGeant4Event* GetEvent() const { return fEvent; }
     inline void SetEvent(TRestGeant4Event* event) { fEvent = event; }
 
-    inline TVector3 GetMomentumDirection(size_t n) const { return fMomentumDirection[n]; }
+    inline TVector3 GetMomentumDirection(size_t n) const {
+        return IsCompact() ? DecodeDirection(fMomentumDirectionCompact[2 * n],
+                                             fMomentumDirectionCompact[2 * n + 1])
+                           : fMomentumDirection[n];
+    }
 
-    inline Int_t GetProcessId(size_t n) const { return fProcessID[n]; }
+    inline Int_t GetProcessId(size_t n) const {
+        return IsCompact() ? Int_t(fProcessIDCompact[n]) : fProcessID[n];
+    }
     inline Int_t GetProcess(size_t n) const { return GetProcessId(n); }
     inline Int_t GetHitProcess(size_t n) const { return GetProcessId(n); }
     TString GetProcessName(size_t n) const;
 
-    inline Int_t GetVolumeId(size_t n) const { return fVolumeID[n]; }
+    inline Int_t GetVolumeId(size_t n) const {
+        return IsCompact() ? Int_t(fVolumeIDCompact[n]) : fVolumeID[n];
+    }
     inline Int_t GetHitVolume(size_t n) const { return GetVolumeId(n); }
     TString GetVolumeName(size_t n) const;
 
     inline bool GetHadronicOk() const { return fHadronicTargetIsotopeName.size() > 0; }
-    inline std::string GetHadronicTargetIsotopeName(size_t n) const { return fHadronicTargetIsotopeName[n]; }
+    inline const std::string& GetHadronicTargetIsotopeName(size_t n) const {
+        return fHadronicTargetIsotopeName[n];
+    }
     inline int GetHadronicTargetIsotopeA(size_t n) const { return fHadronicTargetIsotopeA[n]; }
     inline int GetHadronicTargetIsotopeZ(size_t n) const { return fHadronicTargetIsotopeZ[n]; }
 
     void RemoveG4Hits();
+    void AddG4Hit(const TVector3& position, Double_t energy, Double_t time, Int_t processID, Int_t volumeID,
+                  Double_t kineticEnergy = 0, const TVector3& momentumDirection = {0, 0, 1});
 
     inline Double_t GetKineticEnergy(size_t n) const { return fKineticEnergy[n]; }
 
@@ -80,14 +103,22 @@ class TRestGeant4Hits : public TRestHits {
     size_t GetNumberOfHitsInVolume(Int_t volumeID) const;
 
     // non-const methods (should only be used on the analysis, carefully)
-    std::vector<Float_t>& GetEnergyRef() { return fEnergy; }
+    std::vector<Float_t>& GetEnergyRef();
+
+    /// True if the hits are stored in the compact form (see Compact)
+    inline bool IsCompact() const { return !fVolumeIDCompact.empty(); }
+    bool Compact(Int_t positionMantissaBits = 23, Int_t timeMantissaBits = 23);
+    void Expand();
+
+    static void EncodeDirection(const TVector3& direction, UShort_t& u, UShort_t& v);
+    static TVector3 DecodeDirection(UShort_t u, UShort_t v);
 
     // Constructor
     TRestGeant4Hits();
     // Destructor
     virtual ~TRestGeant4Hits();
 
-    ClassDef(TRestGeant4Hits, 8);  // REST event superclass
+    ClassDef(TRestGeant4Hits, 9);  // REST event superclass
 
     // restG4
    public:
@@ -31,10 +31,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 #include "TRestGeant4BiasingVolume.h"
@@ -56,6 +58,9 @@ class TRestGeant4Metadata : public TRestMetadata {
     void ReadDetector();
     void ReadBiasing();
 
+    void BuildActiveVolumeIndex() const;
+    void UpdateActiveVolumeIndex() const;
+
     // Metadata is the result of a merge of other metadata
     bool fIsMerge = false;
 
@@ -96,6 +101,13 @@ class TRestGeant4Metadata : public TRestMetadata {
     /// \brief A std::vector to store the maximum step size at a particular volume.
     std::vector<Double_t> fMaxStepSize;
 
+    /// \brief Index of each name of fActiveVolumes, exact and lower case (first match), backing all the
+    /// active volume lookups by name. It is built by ReadDetector and the copy, and on demand (under a lock)
+    /// after reading the metadata from a file, so that lookups from Geant4 worker threads are safe.
+    mutable std::unordered_map<std::string, Int_t> fActiveVolumeIndex;            //!
+    mutable std::unordered_map<std::string, Int_t> fActiveVolumeIndexIgnoreCase;  //!
+    mutable std::atomic<bool> fActiveVolumeIndexValid{false};                     //!
+
     /// \brief It the defines the primary source properties, particle type, momentum, energy, etc.
     std::vector<TRestGeant4ParticleSource*> fParticleSource;  //->
 
@@ -345,6 +357,9 @@ class TRestGeant4Metadata : public TRestMetadata {
     /// name.
     Double_t GetStorageChance(const TString& volume);
 
+    /// \brief Returns the maximum step size in the storage volume with index n.
+    inline Double_t GetMaxStepSize(Int_t n) const { return fMaxStepSize[n]; }
+
     Double_t GetMaxStepSize(const TString& volume);
 
     /// Returns the minimum event energy required for an event to be stored.
@@ -410,7 +425,7 @@ class TRestGeant4Metadata : public TRestMetadata {
     /// Returns the world magnetic field in Tesla
     inline TVector3 GetMagneticField() const { return fMagneticField; }
 
-    Int_t GetActiveVolumeID(const TString& name);
+    Int_t GetActiveVolumeID(const TString& name) const;
 
     Bool_t isVolumeStored(const TString& volume) const;
 
@@ -49,6 +49,48 @@ class TRestGeant4NeutronTaggingProcess : public TRestEventProcess {
     std::map<std::string, std::vector<std::string>> fVetoGroupVolumeNames;  //!
     std::vector<Float_t> fQuenchingFactors;                                 //!
 
+    /// IDs in TRestGeant4PhysicsInfo of the particles and processes used in the analysis
+    Int_t fNeutronID = -1;                //!
+    Int_t fGammaID = -1;                  //!
+    Int_t fElectronID = -1;               //!
+    Int_t fPositronID = -1;               //!
+    Int_t fNeutronCaptureProcessID = -1;  //!
+    Int_t fTransportationProcessID = -1;  //!
+
+    /// Position of each volume ID in fVetoVolumeIds, -1 for volumes that are not vetoes
+    std::vector<Int_t> fVetoIndexByVolumeID;  //!
+
+    /// Names of the veto volumes, their IDs in TRestGeant4GeometryInfo (-1 if not found), and veto indices
+    /// of each group following fVetoGroupVolumeNames order
+    std::vector<std::string> fVetoVolumeNames;           //!
+    std::vector<Int_t> fVetoGeometryIDs;                 //!
+    std::vector<size_t> fVetoIndicesByName;              //!
+    std::vector<std::vector<size_t>> fVetoGroupIndices;  //!
+
+    /// Veto observable names, precomputed at InitProcess. Set 0 holds the unquenched observables and set
+    /// q + 1 the ones for fQuenchingFactors[q], see SetVetoEnergyObservables
+    std::vector<std::string> fVetoEDepObservables;           //! // [set * vetoes + vetoIndex]
+    std::vector<std::string> fVetoAllEVetoMaxObservables;    //! // [set]
+    std::vector<std::string> fVetoGroupEVetoMaxObservables;  //! // [set * groups + groupIndex]
+
+    /// Energy in each veto for the observable set being filled
+    std::vector<Double_t> fVetoEnergy;  //!
+    /// Unquenched energy deposited in each veto by electrons, positrons and gammas, and by any other
+    /// particle. Quenched energies are electromagnetic + quenchingFactor * nuclear
+    std::vector<Double_t> fVetoElectromagneticEnergy;  //!
+    std::vector<Double_t> fVetoNuclearEnergy;          //!
+
+    /// Hits in the vetoes as (veto index, energy), sorted by the pre-order position of their track (see
+    /// TRestGeant4Event::GetTracksInPreOrder). The hits of the tracks at pre-order positions [a, b) are the
+    /// range [fVetoDepositOffsets[a], fVetoDepositOffsets[b]), so the hits of a track and all its
+    /// descendants are contiguous. Only built for events with neutron captures, see BuildVetoDeposits
+    std::vector<std::pair<Int_t, Double_t>> fVetoDeposits;  //!
+    std::vector<size_t> fVetoDepositOffsets;                //!
+    /// Energy deposited by each track, by track index
+    std::vector<Double_t> fTrackEnergy;  //!
+    /// Energy deposited in each veto by the subtree of the current neutron capture
+    std::vector<Double_t> fSubtreeEnergyInVeto;  //!
+
     // neutrons that undergo neutron capture
     Int_t fNeutronsCapturedNumber;  //!
     /// TODO it might be simplified using std::vector<TVector3>
@@ -87,6 +129,9 @@ class TRestGeant4NeutronTaggingProcess : public TRestEventProcess {
     void Initialize() override;
     void LoadDefaultConfig();
     void Reset();
+    void BuildVetoObservableNames();
+    void BuildVetoDeposits(bool withCaptures);
+    void SetVetoEnergyObservables(size_t observableSet);
 
    protected:
     // add here the members of your event process
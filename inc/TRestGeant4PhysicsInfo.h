@@ -33,6 +33,23 @@ class TRestGeant4PhysicsInfo {
     void InsertParticleName(Int_t id, const TString& particleName);
     std::set<TString> GetAllProcesses() const;
 
+    inline bool IsValidProcess(const TString& processName) const {
+        return fProcessNamesReverseMap.count(processName) > 0;
+    }
+    inline bool IsValidParticle(const TString& particleName) const {
+        return fParticleNamesReverseMap.count(particleName) > 0;
+    }
+
+    /// Same as GetProcessID and GetParticleID, but returning -1 for unknown names
+    inline Int_t FindProcessID(const TString& processName) const {
+        const auto it = fProcessNamesReverseMap.find(processName);
+        return it != fProcessNamesReverseMap.end() ? it->second : -1;
+    }
+    inline Int_t FindParticleID(const TString& particleName) const {
+        const auto it = fParticleNamesReverseMap.find(particleName);
+        return it != fParticleNamesReverseMap.end() ? it->second : -1;
+    }
+
     TString GetProcessType(const TString& processName) const;
     std::set<TString> GetAllProcessTypes() const;
 
@@ -23,11 +23,35 @@
 #ifndef RestCore_TRestGeant4QuenchingProcess
 #define RestCore_TRestGeant4QuenchingProcess
 
+#include <TMath.h>
 #include <TRestEventProcess.h>
 
+#include <set>
+#include <vector>
+
 #include "TRestGeant4Event.h"
 #include "TRestGeant4Metadata.h"
 
+/// Coefficients of the Lindhard quenching factor for a given target isotope, so that evaluating the factor
+/// for a recoil energy only needs a single power
+struct TRestGeant4LindhardCoefficients {
+    /// 11.5 * Z^(-7/3), the reduced energy per unit of recoil energy
+    Double_t gammaPerEnergy = 0;
+    /// 0.133 * Z^(2/3) * A^(-1/2)
+    Double_t k = 0;
+
+    TRestGeant4LindhardCoefficients() = default;
+    TRestGeant4LindhardCoefficients(Int_t A, Int_t Z);
+
+    inline Double_t Evaluate(Double_t recoilEnergy) const {
+        const Double_t gamma = gammaPerEnergy * recoilEnergy;
+        const Double_t gamma015 = TMath::Power(gamma, 0.15);
+        const Double_t gamma030 = gamma015 * gamma015;
+        const Double_t g = 3 * gamma015 + 0.7 * gamma030 * gamma030 + gamma;
+        return k * g / (1 + k * g);
+    }
+};
+
 //! Recomputes the energy of every hit based on quenching factor for each particle and volume
 class TRestGeant4QuenchingProcess : public TRestEventProcess {
    private:
@@ -43,6 +67,17 @@ class TRestGeant4QuenchingProcess : public TRestEventProcess {
     std::set<std::string> fUserVolumeExpressions;
     std::set<std::string> fVolumes;
 
+    /// Geometry volume IDs of fVolumes, as a membership bitmap indexed by volume ID
+    std::vector<bool> fQuenchedVolumeIDs;  //!
+
+    /// Lindhard coefficients for A = 1, indexed by Z, and A^(-1/2) indexed by A, computed at InitProcess.
+    /// The coefficients of an isotope (A, Z) are the ones of Z with k scaled by A^(-1/2)
+    std::vector<TRestGeant4LindhardCoefficients> fLindhardCoefficientsByZ;  //!
+    std::vector<Double_t> fLindhardInverseSqrtA;                            //!
+
+    void BuildLindhardTables();
+    TRestGeant4LindhardCoefficients GetLindhardCoefficients(Int_t A, Int_t Z) const;
+
     void Initialize() override;
     void InitFromConfigFile() override;
     void LoadDefaultConfig();
@@ -51,6 +86,8 @@ class TRestGeant4QuenchingProcess : public TRestEventProcess {
     std::set<std::string> GetUserVolumeExpressions() const;
     std::set<std::string> GetVolumes() const;
 
+    static Double_t LindhardQuenchingFactor(Double_t recoilEnergy, Int_t A, Int_t Z);
+
     RESTValue GetInputEvent() const override { return fInputG4Event; }
     RESTValue GetOutputEvent() const override { return fOutputG4Event; }
 
@@ -30,8 +30,8 @@ class G4Step;
 // Perhaps there might be need for a mother class TRestTrack (if there is future need)
 class TRestGeant4Track {
    protected:
-    Int_t fTrackID;
-    Int_t fParentID;
+    Int_t fTrackID = 0;
+    Int_t fParentID = 0;
 
     TString fParticleName;
 
@@ -41,12 +41,12 @@ class TRestGeant4Track {
 
     std::vector<Int_t> fSecondaryTrackIDs;
 
-    Double_t fGlobalTimestamp;
+    Double_t fGlobalTimestamp = 0;
     Double_t fTimeOffset = 0;
-    Double_t fTimeLength;
+    Double_t fTimeLength = 0;
 
-    Double_t fInitialKineticEnergy;
-    Double_t fLength;
+    Double_t fInitialKineticEnergy = 0;
+    Double_t fLength = 0;
 
     TVector3 fInitialPosition;
 
@@ -54,21 +54,54 @@ class TRestGeant4Track {
 
     TRestGeant4Event* fEvent = nullptr;  //!
 
+    const TRestGeant4Metadata* fGeant4Metadata = nullptr;  //!
+
+    /// IDs of fParticleName and fCreatorProcess in TRestGeant4PhysicsInfo, -1 if unknown
+    Int_t fParticleID = -1;        //!
+    Int_t fCreatorProcessID = -1;  //!
+
+    /// True when the hits of the current entry have not been read yet (see TRestGeant4Event lazy loading)
+    Bool_t fHitsPending = false;  //!
+
+    void LoadHits() const;
+
    public:
-    inline const TRestGeant4Hits& GetHits() const { return fHits; }
-    inline TRestGeant4Hits* GetHitsPointer() { return &fHits; }
+    inline const TRestGeant4Hits& GetHits() const {
+        if (fHitsPending) {
+            LoadHits();
+        }
+        return fHits;
+    }
+    /// Gives write access to the hits. The hits columns of the event are dropped, see
+    /// TRestGeant4Event::BuildHitsColumns
+    TRestGeant4Hits* GetHitsPointer();
     inline const TRestGeant4Event* GetEvent() const { return fEvent; }
     const TRestGeant4Metadata* GetGeant4Metadata() const;
 
     inline void SetEvent(TRestGeant4Event* event) { fEvent = event; }
-    inline void SetHits(const TRestGeant4Hits& hits) {
-        fHits = hits;
-        fHits.SetTrack(this);
-    }
+    void SetGeant4Metadata(const TRestGeant4Metadata* metadata);
+    void SetHits(const TRestGeant4Hits& hits);
 
     inline void SetTimeOffset(const double tOffset) { fTimeOffset = tOffset; }
 
+    // Setters to build tracks outside restG4, before adding them to an event (TRestGeant4Event::AddTrack)
+    inline void SetTrackID(Int_t trackID) { fTrackID = trackID; }
+    inline void SetParentID(Int_t parentID) { fParentID = parentID; }
+    inline void SetParticleName(const TString& particleName) {
+        fParticleName = particleName;
+        SetGeant4Metadata(fGeant4Metadata);
+    }
+    inline void SetCreatorProcess(const TString& processName) {
+        fCreatorProcess = processName;
+        SetGeant4Metadata(fGeant4Metadata);
+    }
+    inline void SetInitialKineticEnergy(Double_t energy) { fInitialKineticEnergy = energy; }
+    inline void SetInitialPosition(const TVector3& position) { fInitialPosition = position; }
+    inline void SetGlobalTime(Double_t time) { fGlobalTimestamp = time; }
+
     inline TString GetCreatorProcess() const { return fCreatorProcess; }
+    /// ID of the creator process in TRestGeant4PhysicsInfo, -1 if it is not known (no metadata bound)
+    inline Int_t GetCreatorProcessID() const { return fCreatorProcessID; }
 
     inline void AddSecondaryTrackID(Int_t trackID) { fSecondaryTrackIDs.push_back(trackID); }
 
@@ -78,13 +111,26 @@ class TRestGeant4Track {
     inline Int_t GetTrackID() const { return fTrackID; }
     inline Int_t GetParentID() const { return fParentID; }
     inline TString GetParticleName() const { return fParticleName; }
+    /// ID of the particle in TRestGeant4PhysicsInfo, -1 if it is not known (no metadata bound)
+    inline Int_t GetParticleID() const { return fParticleID; }
+    /// True if the track is the given particle. The IDs are compared when both are known, otherwise the
+    /// names are compared (e.g. no metadata bound, or a particle not present in TRestGeant4PhysicsInfo)
+    inline bool IsParticle(Int_t particleID, const TString& particleName) const {
+        return (particleID >= 0 && fParticleID >= 0) ? fParticleID == particleID
+                                                     : fParticleName == particleName;
+    }
+    /// Same as IsParticle, for the creator process of the track
+    inline bool IsCreatorProcess(Int_t processID, const TString& processName) const {
+        return (processID >= 0 && fCreatorProcessID >= 0) ? fCreatorProcessID == processID
+                                                          : fCreatorProcess == processName;
+    }
     inline Double_t GetGlobalTime() const { return fGlobalTimestamp; }
     inline Double_t GetTimeOffset() const { return fTimeOffset; }
     inline Double_t GetTimeLength() const { return fTimeLength; }
     inline Double_t GetInitialKineticEnergy() const { return fInitialKineticEnergy; }
     inline TVector3 GetInitialPosition() const { return fInitialPosition; }
     inline Double_t GetWeight() const { return fWeight; }
-    inline Double_t GetTotalEnergy() const { return fHits.GetTotalEnergy(); }
+    inline Double_t GetTotalEnergy() const { return GetHits().GetTotalEnergy(); }
     inline Double_t GetLength() const { return fLength; }
 
     TString GetInitialVolume() const;
@@ -100,15 +146,15 @@ class TRestGeant4Track {
 
     EColor GetParticleColor() const;
 
-    inline Double_t GetEnergyInVolume(Int_t volID) const { return fHits.GetEnergyInVolume(volID); }
+    inline Double_t GetEnergyInVolume(Int_t volID) const { return GetHits().GetEnergyInVolume(volID); }
     inline TVector3 GetMeanPositionInVolume(Int_t volID) const {
-        return fHits.GetMeanPositionInVolume(volID);
+        return GetHits().GetMeanPositionInVolume(volID);
     }
     inline TVector3 GetFirstPositionInVolume(Int_t volID) const {
-        return fHits.GetFirstPositionInVolume(volID);
+        return GetHits().GetFirstPositionInVolume(volID);
     }
     inline TVector3 GetLastPositionInVolume(Int_t volID) const {
-        return fHits.GetLastPositionInVolume(volID);
+        return GetHits().GetLastPositionInVolume(volID);
     }
 
     Int_t GetProcessID(const TString& processName) const;
@@ -122,6 +168,7 @@ class TRestGeant4Track {
         return ContainsProcessInVolume(processName, -1);
     }
 
+    Double_t GetEnergyInVolume(Int_t volumeID, bool children) const;
     Double_t GetEnergyInVolume(const TString& volumeName, bool children = false) const;
 
     TString GetLastProcessName() const;
@@ -130,7 +177,7 @@ class TRestGeant4Track {
     void PrintTrack(size_t maxHits = 0) const;
     void PrintTrackFilterVolumes(const std::set<std::string>& filterVolumes) const;
 
-    inline void RemoveHits() { fHits.RemoveHits(); }
+    inline void RemoveHits() { GetHitsPointer()->RemoveHits(); }
 
     // Constructor
     TRestGeant4Track();
@@ -53,10 +53,25 @@ class TRestGeant4VetoAnalysisProcess : public TRestEventProcess {
     const TRestGeant4Metadata* fGeant4Metadata = nullptr;  //!
 
     std::vector<Veto> fVetoVolumes;
+    // per veto tables, parallel to fVetoVolumes
+    std::vector<Int_t> fVetoVolumeIDs;                //! // geometry volume IDs
+    std::vector<size_t> fVetoGroupIndex;              //! // index in fVetoGroups
+    std::vector<size_t> fVetoGroupLayerIndex;         //! // index in fVetoGroupLayers
+    std::vector<size_t> fVetoLayerIndex;              //! // index in fVetoLayers
+    std::vector<std::string> fVetoEnergyObservables;  //! // `EnergyVeto_<alias>`
+
+    std::vector<std::string> fVetoGroups;                       //! // sorted, without duplicates
+    std::vector<std::pair<std::string, int>> fVetoGroupLayers;  //! // sorted, without duplicates
+    std::vector<int> fVetoLayers;                               //! // sorted, without duplicates
+
+    Int_t fNeutronParticleID = -1;        //!
+    Int_t fGammaParticleID = -1;          //!
+    Int_t fNeutronCaptureProcessID = -1;  //!
 
     void InitFromConfigFile() override;
     void Initialize() override;
     void LoadDefaultConfig();
+    void BuildVetoTables();
 
    public:
     RESTValue GetInputEvent() const override { return fInputEvent; }
@@ -194,6 +194,8 @@
 
 #include "TRestGeant4AnalysisProcess.h"
 
+#include <algorithm>
+
 using namespace std;
 
 ClassImp(TRestGeant4AnalysisProcess);
@@ -224,7 +226,7 @@ TRestGeant4AnalysisProcess::TRestGeant4AnalysisProcess(const char* configFilenam
 ///////////////////////////////////////////////
 /// \brief Default destructor
 ///
-TRestGeant4AnalysisProcess::~TRestGeant4AnalysisProcess() { delete fOutputG4Event; }
+TRestGeant4AnalysisProcess::~TRestGeant4AnalysisProcess() = default;
 
 ///////////////////////////////////////////////
 /// \brief Function to load the default config in absence of RML input
@@ -240,8 +242,9 @@ void TRestGeant4AnalysisProcess::Initialize() {
     SetSectionName(this->ClassName());
     SetLibraryVersion(LIBRARY_VERSION);
 
+    // read-only process, the input event is passed through (see ProcessEvent)
     fInputG4Event = nullptr;
-    fOutputG4Event = new TRestGeant4Event();
+    fOutputG4Event = nullptr;
 }
 
 ///////////////////////////////////////////////
@@ -260,10 +263,36 @@ void TRestGeant4AnalysisProcess::LoadConfig(const string& configFilename, const
     if (LoadConfigFromFile(configFilename, name)) LoadDefaultConfig();
 }
 
+namespace {
+bool EndsWith(const string& name, const string& suffix) {
+    return name.length() > suffix.length() &&
+           name.compare(name.length() - suffix.length(), suffix.length(), suffix) == 0;
+}
+
+void PrintNotActiveVolumeWarning(const TString& volumeName, const TRestGeant4Metadata& metadata) {
+    cout << endl;
+    cout << "??????????????????????????????????????????????????" << endl;
+    cout << "REST warning : TRestGeant4AnalysisProcess." << endl;
+    cout << "------------------------------------------" << endl;
+    cout << endl;
+    cout << " Volume " << volumeName << " is not an active volume" << endl;
+    cout << endl;
+    cout << "List of active volumes : " << endl;
+    cout << "------------------------ " << endl;
+
+    for (unsigned int n = 0; n < metadata.GetNumberOfActiveVolumes(); n++)
+        cout << "Volume " << n << " : " << metadata.GetActiveVolumeName(n) << endl;
+    cout << "??????????????????????????????????????????????????" << endl;
+    cout << endl;
+}
+}  // namespace
+
 ///////////////////////////////////////////////
-/// \brief Process initialization. Observable names are interpreted and auxiliar
-/// observable members, related to VolumeEdep, MeanPos, TracksCounter, TrackEDep
-/// observables defined in TRestGeant4AnalysisProcess are filled at this stage.
+/// \brief Process initialization. Observable names are interpreted once into
+/// TRestGeant4AnalysisObservable descriptors, related to VolumeEdep, MeanPos,
+/// TracksCounter, TrackEDep observables, with their volume, particle and process
+/// IDs resolved. The single pass execution plan used by ProcessEvent is built
+/// from them.
 ///
 void TRestGeant4AnalysisProcess::InitProcess() {
     fG4Metadata = GetMetadata<TRestGeant4Metadata>();
@@ -283,110 +312,136 @@ void TRestGeant4AnalysisProcess::InitProcess() {
         fObservables.emplace_back("PerProcessHadronElastic");
         fObservables.emplace_back("PerProcessNeutronElastic");
     }
-    for (unsigned int i = 0; i < fObservables.size(); i++) {
-        if (fObservables[i].find("VolumeEDep") != string::npos) {
-            TString volName = fObservables[i].substr(0, fObservables[i].length() - 10).c_str();
-
-            Int_t volId = fG4Metadata->GetActiveVolumeID(volName);
-            if (volId >= 0) {
-                fEnergyInObservables.push_back(fObservables[i]);
-                fVolumeID.push_back(volId);
-                fVolumeName.push_back(volName.Data());
-            }
 
-            if (volId == -1) {
-                cout << endl;
-                cout << "??????????????????????????????????????????????????" << endl;
-                cout << "REST warning : TRestGeant4AnalysisProcess." << endl;
-                cout << "------------------------------------------" << endl;
-                cout << endl;
-                cout << " Volume " << volName << " is not an active volume" << endl;
-                cout << endl;
-                cout << "List of active volumes : " << endl;
-                cout << "------------------------ " << endl;
-
-                for (unsigned int n = 0; n < fG4Metadata->GetNumberOfActiveVolumes(); n++)
-                    cout << "Volume " << n << " : " << fG4Metadata->GetActiveVolumeName(n) << endl;
-                cout << "??????????????????????????????????????????????????" << endl;
-                cout << endl;
-            }
-        }
+    fGenericObservables.clear();
 
-        if (fObservables[i].find("MeanPos") != string::npos) {
-            TString volName2 = fObservables[i].substr(0, fObservables[i].length() - 8).c_str();
-            std::string dirId = fObservables[i].substr(fObservables[i].length() - 1, 1);
+    // process names as named by Geant4
+    // processes present here will be added to the list of observables which can be used to see if the event
+    // contains the process of interest.
+    const vector<string> processNames = {"phot", "compt"};
+    for (auto processName : processNames) {
+        TRestGeant4AnalysisObservable observable;
+        observable.kind = TRestGeant4AnalysisObservable::Kind::CONTAINS_PROCESS;
+        observable.processID = fG4Metadata->GetGeant4PhysicsInfo().GetProcessID(processName);
+        processName[0] = toupper(processName[0]);
+        observable.name = "containsProcess" + processName;
+        fGenericObservables.push_back(observable);
+    }
 
-            Int_t volId2 = fG4Metadata->GetActiveVolumeID(volName2);
-            if (volId2 >= 0) {
-                fMeanPosObservables.push_back(fObservables[i]);
-                fVolumeID2.push_back(volId2);
-                fDirID.push_back(dirId);
-            }
+    for (const auto& observableName : fObservables) {
+        TRestGeant4AnalysisObservable observable;
+        if (ParseObservable(observableName, observable)) {
+            fGenericObservables.push_back(observable);
+        }
+    }
 
-            if (volId2 == -1) {
-                cout << endl;
-                cout << "??????????????????????????????????????????????????" << endl;
-                cout << "REST warning : TRestGeant4AnalysisProcess." << endl;
-                cout << "------------------------------------------" << endl;
-                cout << endl;
-                cout << " Volume " << volName2 << " is not an active volume" << endl;
-                cout << endl;
-                cout << "List of active volumes : " << endl;
-                cout << "------------------------ " << endl;
-
-                for (unsigned int n = 0; n < fG4Metadata->GetNumberOfActiveVolumes(); n++)
-                    cout << "Volume " << n << " : " << fG4Metadata->GetActiveVolumeName(n) << endl;
-                cout << "??????????????????????????????????????????????????" << endl;
-                cout << endl;
-            }
+    // keep the order in which the values were set before descriptors were introduced
+    std::stable_sort(fGenericObservables.begin(), fGenericObservables.end(),
+                     [](const TRestGeant4AnalysisObservable& a, const TRestGeant4AnalysisObservable& b) {
+                         return a.kind < b.kind;
+                     });
 
-            if ((dirId != "X") && (dirId != "Y") && (dirId != "Z")) {
-                cout << endl;
-                cout << "??????????????????????????????????????????????????" << endl;
-                cout << "REST warning : TRestGeant4AnalysisProcess." << endl;
-                cout << "------------------------------------------" << endl;
-                cout << endl;
-                cout << " Direction " << dirId << " is not valid" << endl;
-                cout << " Only X, Y or Z accepted" << endl;
-                cout << endl;
-            }
+    BuildPlan();
+}
+
+///////////////////////////////////////////////
+/// \brief It interprets the name of a generic observable (`xxxVolumeEDep`,
+/// `xxxMeanPosX`, `xxxTracksCounter`, `xxxTracksEDep`) and resolves its volume and
+/// particle IDs. It returns false if the name does not correspond to a generic
+/// observable, or if its volume is not an active volume.
+///
+bool TRestGeant4AnalysisProcess::ParseObservable(const string& observableName,
+                                                 TRestGeant4AnalysisObservable& observable) {
+    observable.name = observableName;
+
+    if (EndsWith(observableName, "VolumeEDep")) {
+        observable.kind = TRestGeant4AnalysisObservable::Kind::VOLUME_EDEP;
+        observable.volumeName = observableName.substr(0, observableName.length() - 10).c_str();
+        if (fG4Metadata->GetActiveVolumeID(observable.volumeName) < 0) {
+            PrintNotActiveVolumeWarning(observable.volumeName, *fG4Metadata);
+            return false;
         }
-        if (fObservables[i].find("Process") != string::npos) {
-            Int_t ls = 0;
-            if (fObservables[i].find("RadiactiveDecay") != string::npos) ls = 15;
-            if (fObservables[i].find("Photoelectric") != string::npos) ls = 13;
-            if (fObservables[i].find("PhotonNuclear") != string::npos) ls = 13;
-            if (fObservables[i].find("Bremstralung") != string::npos) ls = 12;
-            if (fObservables[i].find("NInelastic") != string::npos) ls = 10;
-            if (fObservables[i].find("HadElastic") != string::npos) ls = 10;
-            if (fObservables[i].find("NCapture") != string::npos) ls = 8;
-            if (fObservables[i].find("Compton") != string::npos) ls = 7;
-            if (fObservables[i].find("Neutron") != string::npos) ls = 7;
-            if (fObservables[i].find("Alpha") != string::npos) ls = 5;
-            if (fObservables[i].find("Argon") != string::npos) ls = 5;
-            if (fObservables[i].find("Xenon") != string::npos) ls = 5;
-            if (fObservables[i].find("Neon") != string::npos) ls = 4;
-
-            TString processName = fObservables[i].substr(fObservables[i].length() - (ls + 7), ls).c_str();
-            TString volName3 = fObservables[i].substr(0, fObservables[i].length() - (ls + 7)).c_str();
-            Int_t volId3 = fG4Metadata->GetActiveVolumeID(volName3);
-
-            if (volId3 >= 0) {
-                fProcessObservables.push_back(fObservables[i]);
-                fVolumeID3.push_back(volId3);
-                fProcessName.emplace_back(processName.Data());
-            }
+        const auto& geometryInfo = fG4Metadata->GetGeant4GeometryInfo();
+        if (geometryInfo.HasVolumeID(observable.volumeName)) {
+            observable.volumeID = geometryInfo.GetIDFromVolume(observable.volumeName);
         }
-        if (fObservables[i].find("TracksCounter") != string::npos) {
-            TString particleName = fObservables[i].substr(0, fObservables[i].length() - 13).c_str();
-            fTrackCounterObservables.push_back(fObservables[i]);
-            fParticleTrackCounter.emplace_back(particleName.Data());
+        return true;
+    }
+
+    const size_t meanPosition = observableName.rfind("MeanPos");
+    if (meanPosition != string::npos && meanPosition > 0 && meanPosition + 8 == observableName.length()) {
+        observable.kind = TRestGeant4AnalysisObservable::Kind::MEAN_POS;
+        observable.volumeName = observableName.substr(0, meanPosition).c_str();
+        // the mean position is queried with the active volume ID
+        observable.volumeID = fG4Metadata->GetActiveVolumeID(observable.volumeName);
+        if (observable.volumeID < 0) {
+            PrintNotActiveVolumeWarning(observable.volumeName, *fG4Metadata);
+            return false;
         }
 
-        if (fObservables[i].find("TracksEDep") != string::npos) {
-            TString particleName = fObservables[i].substr(0, fObservables[i].length() - 10).c_str();
-            fTracksEDepObservables.push_back(fObservables[i]);
-            fParticleTrackEdep.emplace_back(particleName.Data());
+        const char direction = observableName.back();
+        if (direction == 'X' || direction == 'Y' || direction == 'Z') {
+            observable.axis = direction - 'X';
+        } else {
+            cout << endl;
+            cout << "??????????????????????????????????????????????????" << endl;
+            cout << "REST warning : TRestGeant4AnalysisProcess." << endl;
+            cout << "------------------------------------------" << endl;
+            cout << endl;
+            cout << " Direction " << direction << " is not valid" << endl;
+            cout << " Only X, Y or Z accepted" << endl;
+            cout << endl;
+        }
+        return true;
+    }
+
+    if (EndsWith(observableName, "TracksCounter")) {
+        observable.kind = TRestGeant4AnalysisObservable::Kind::TRACKS_COUNTER;
+        observable.particleName = observableName.substr(0, observableName.length() - 13).c_str();
+        observable.particleID = fG4Metadata->GetGeant4PhysicsInfo().FindParticleID(observable.particleName);
+        return true;
+    }
+
+    if (EndsWith(observableName, "TracksEDep")) {
+        observable.kind = TRestGeant4AnalysisObservable::Kind::TRACKS_EDEP;
+        observable.particleName = observableName.substr(0, observableName.length() - 10).c_str();
+        observable.particleID = fG4Metadata->GetGeant4PhysicsInfo().FindParticleID(observable.particleName);
+        return true;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////
+/// \brief It registers in fPlan the volumes, particles and processes required by the observables, so
+/// that ProcessEvent computes all of them in a single pass over the event tracks and hits. The slot of
+/// each observable value in the plan is stored in its descriptor.
+///
+void TRestGeant4AnalysisProcess::BuildPlan() {
+    const auto& geometryInfo = fG4Metadata->GetGeant4GeometryInfo();
+
+    fPlan.Clear();
+
+    const TString sensitiveVolumeName = fG4Metadata->GetSensitiveVolume();
+    if (geometryInfo.HasVolumeID(sensitiveVolumeName)) {
+        fPlan.SetSensitiveVolumeID(geometryInfo.GetIDFromVolume(sensitiveVolumeName));
+    }
+
+    for (auto& observable : fGenericObservables) {
+        switch (observable.kind) {
+            case TRestGeant4AnalysisObservable::Kind::CONTAINS_PROCESS:
+                observable.slot = fPlan.AddProcess(observable.processID);
+                break;
+            case TRestGeant4AnalysisObservable::Kind::TRACKS_COUNTER:
+            case TRestGeant4AnalysisObservable::Kind::TRACKS_EDEP:
+                observable.slot = fPlan.AddParticle(observable.particleName, observable.particleID);
+                break;
+            case TRestGeant4AnalysisObservable::Kind::MEAN_POS:
+                observable.slot = fPlan.AddMeanPositionVolume(observable.volumeID);
+                break;
+            case TRestGeant4AnalysisObservable::Kind::VOLUME_EDEP:
+                // read from the event energy index
+                break;
         }
     }
 }
@@ -396,50 +451,31 @@ void TRestGeant4AnalysisProcess::InitProcess() {
 ///
 TRestEvent* TRestGeant4AnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
     fInputG4Event = (TRestGeant4Event*)inputEvent;
-    *fOutputG4Event = *((TRestGeant4Event*)inputEvent);
+    // the event is not modified, there is no need to copy it
+    fOutputG4Event = fInputG4Event;
 
     const auto sensitiveVolumeName = fG4Metadata->GetSensitiveVolume();
+    const Int_t sensitiveVolumeID = fPlan.GetSensitiveVolumeID();
 
     Double_t sensitiveVolumeEnergy = fOutputG4Event->GetEnergyInVolume(sensitiveVolumeName.Data());
-    // Get time of the first hit in the sensitive volume
-    double hitTime = std::numeric_limits<double>::infinity();
-    std::set<int> trackIdsInSensitiveVolume;
 
-    for (const auto& track : fOutputG4Event->GetTracks()) {
-        const auto& hits = track.GetHits();
-        for (size_t hitIndex = 0; hitIndex < hits.GetNumberOfHits(); hitIndex++) {
-            const auto volumeName = hits.GetVolumeName(hitIndex);
-            if (volumeName != sensitiveVolumeName) {
-                continue;
-            }
-            const double energy = hits.GetEnergy(hitIndex);
-            if (energy <= 0) {
-                continue;
-            }
-
-            const double time = hits.GetTime(hitIndex);
-            if (time < hitTime) {
-                hitTime = time;
-            }
-
-            trackIdsInSensitiveVolume.insert(track.GetTrackID());
-        }
-    }
+    // a single pass over the tracks and hits fills all the per-hit and per-track observables
+    fPlan.Fill(*fOutputG4Event);
 
-    SetObservableValue("sensitiveVolumeFirstHitTime", hitTime);
+    // Get time of the first hit in the sensitive volume
+    SetObservableValue("sensitiveVolumeFirstHitTime", fPlan.GetSensitiveVolumeFirstHitTime());
 
     std::set<int> trackParentsOfInterest;
-    for (const auto& trackIdInSensitiveVolume : trackIdsInSensitiveVolume) {
+    for (const auto& trackIdInSensitiveVolume : fPlan.GetTrackIDsInSensitiveVolume()) {
         const auto track = fOutputG4Event->GetTrackByID(trackIdInSensitiveVolume);
         TRestGeant4Track* parent = track;
         bool found = false;
         while (parent != nullptr && !found) {
             // iterate over hits
             const auto& hits = parent->GetHits();
-            if (hits.GetVolumeName(0) != sensitiveVolumeName) {
+            if (hits.GetVolumeId(0) != sensitiveVolumeID) {
                 for (size_t hitIndex = 0; hitIndex < hits.GetNumberOfHits(); hitIndex++) {
-                    const auto volumeName = hits.GetVolumeName(hitIndex);
-                    if (volumeName != sensitiveVolumeName) {
+                    if (hits.GetVolumeId(hitIndex) != sensitiveVolumeID) {
                         found = true;
                         trackParentsOfInterest.insert(parent->GetTrackID());
                         break;
@@ -532,67 +568,238 @@ TRestEvent* TRestGeant4AnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
     Double_t energyTotal = fOutputG4Event->GetTotalDepositedEnergy();
     SetObservableValue("totalEdep", energyTotal);
 
-    Double_t size = fOutputG4Event->GetBoundingBoxSize();
+    Double_t size = fPlan.GetBoundingBoxSize();
     SetObservableValue("boundingSize", size);
 
-    // process names as named by Geant4
-    // processes present here will be added to the list of observables which can be used to see if the event
-    // contains the process of interest.
-    vector<string> processNames = {"phot", "compt"};
-    for (auto& processName : processNames) {
-        Int_t containsProcess = 0;
-        if (fOutputG4Event->ContainsProcess(fG4Metadata->GetGeant4PhysicsInfo().GetProcessID(processName))) {
-            containsProcess = 1;
+    for (const auto& observable : fGenericObservables) {
+        switch (observable.kind) {
+            case TRestGeant4AnalysisObservable::Kind::CONTAINS_PROCESS:
+                SetObservableValue(observable.name, fPlan.ContainsProcess(observable.slot) ? 1 : 0);
+                break;
+            case TRestGeant4AnalysisObservable::Kind::TRACKS_COUNTER:
+                SetObservableValue(observable.name, fPlan.GetNumberOfTracks(observable.slot));
+                break;
+            case TRestGeant4AnalysisObservable::Kind::TRACKS_EDEP:
+                SetObservableValue(observable.name, fPlan.GetEnergyDepositedByParticle(observable.slot));
+                break;
+            case TRestGeant4AnalysisObservable::Kind::VOLUME_EDEP: {
+                Double_t en = observable.volumeID >= 0
+                                  ? fOutputG4Event->GetEnergyInVolume(observable.volumeID)
+                                  : fOutputG4Event->GetEnergyInVolume(observable.volumeName.Data());
+                SetObservableValue(observable.name, en);
+                break;
+            }
+            case TRestGeant4AnalysisObservable::Kind::MEAN_POS: {
+                Double_t mpos = 0;
+                if (observable.axis >= 0) {
+                    mpos = fPlan.GetMeanPosition(observable.slot)[observable.axis];
+                }
+                SetObservableValue(observable.name, mpos);
+                break;
+            }
         }
+    }
 
-        if (!processName.empty()) {
-            processName[0] = toupper(processName[0]);
-            SetObservableValue("containsProcess" + processName, containsProcess);
-        }
+    if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
+        cout << "G4 Tracks : " << fOutputG4Event->GetNumberOfTracks() << endl;
+        cout << "----------------------------" << endl;
     }
 
-    for (unsigned int n = 0; n < fParticleTrackCounter.size(); n++) {
-        Int_t nT = fOutputG4Event->GetNumberOfTracksForParticle(fParticleTrackCounter[n]);
-        string obsName = fTrackCounterObservables[n];
-        SetObservableValue(obsName, nT);
+    return fOutputG4Event;
+}
+
+///////////////////////////////////////////////
+/// \brief Function to include required actions after all events have been processed.
+void TRestGeant4AnalysisProcess::EndProcess() {}
+
+///////////////////////////////////////////////
+/// \brief Removes all the volumes, particles and processes registered in the plan.
+///
+void TRestGeant4AnalysisPlan::Clear() {
+    fSensitiveVolumeID = -1;
+    fMeanPositionVolumeIDs.clear();
+    fMeanPositionSlotByVolumeID.clear();
+    fParticleNames.clear();
+    fParticleIDs.clear();
+    fProcessIDs.clear();
+    Reset();
+}
+
+///////////////////////////////////////////////
+/// \brief Registers a volume whose energy weighted mean hit position is required, and returns the slot
+/// to be used in GetMeanPosition. Registering the same volume twice returns the same slot.
+///
+size_t TRestGeant4AnalysisPlan::AddMeanPositionVolume(Int_t volumeID) {
+    if (volumeID >= 0 && volumeID < Int_t(fMeanPositionSlotByVolumeID.size()) &&
+        fMeanPositionSlotByVolumeID[volumeID] >= 0) {
+        return fMeanPositionSlotByVolumeID[volumeID];
+    }
+    const size_t slot = fMeanPositionVolumeIDs.size();
+    fMeanPositionVolumeIDs.push_back(volumeID);
+    if (volumeID >= 0) {
+        if (volumeID >= Int_t(fMeanPositionSlotByVolumeID.size())) {
+            fMeanPositionSlotByVolumeID.resize(volumeID + 1, -1);
+        }
+        fMeanPositionSlotByVolumeID[volumeID] = slot;
     }
+    return slot;
+}
 
-    for (unsigned int n = 0; n < fTracksEDepObservables.size(); n++) {
-        Double_t energy = fOutputG4Event->GetEnergyDepositedByParticle(fParticleTrackEdep[n]);
-        string obsName = fTracksEDepObservables[n];
-        SetObservableValue(obsName, energy);
+///////////////////////////////////////////////
+/// \brief Registers a particle whose number of tracks and deposited energy are required, and returns the
+/// slot to be used in GetNumberOfTracks and GetEnergyDepositedByParticle.
+///
+/// Tracks are matched by particle ID when both the given ID and the track ID are resolved, and by name
+/// otherwise, as TRestGeant4Event::GetNumberOfTracksForParticle does.
+///
+size_t TRestGeant4AnalysisPlan::AddParticle(const TString& particleName, Int_t particleID) {
+    for (size_t slot = 0; slot < fParticleNames.size(); slot++) {
+        if (fParticleNames[slot] == particleName) {
+            return slot;
+        }
     }
+    fParticleNames.push_back(particleName);
+    fParticleIDs.push_back(particleID);
+    return fParticleNames.size() - 1;
+}
 
-    for (unsigned int n = 0; n < fEnergyInObservables.size(); n++) {
-        Double_t en = fOutputG4Event->GetEnergyInVolume(fVolumeName[n]);
-        string obsName = fEnergyInObservables[n];
-        SetObservableValue(obsName, en);
+///////////////////////////////////////////////
+/// \brief Registers a process whose presence in the event is required, and returns the slot to be used
+/// in ContainsProcess.
+///
+size_t TRestGeant4AnalysisPlan::AddProcess(Int_t processID) {
+    for (size_t slot = 0; slot < fProcessIDs.size(); slot++) {
+        if (fProcessIDs[slot] == processID) {
+            return slot;
+        }
     }
+    fProcessIDs.push_back(processID);
+    return fProcessIDs.size() - 1;
+}
 
-    for (unsigned int n = 0; n < fMeanPosObservables.size(); n++) {
-        string obsName = fMeanPosObservables[n];
+void TRestGeant4AnalysisPlan::Reset() {
+    fSensitiveVolumeFirstHitTime = std::numeric_limits<double>::infinity();
+    fTrackIDsInSensitiveVolume.clear();
 
-        Double_t mpos = 0;
-        if (fDirID[n] == (TString) "X")
-            mpos = fOutputG4Event->GetMeanPositionInVolume(fVolumeID2[n]).X();
+    fMeanPosition.assign(fMeanPositionVolumeIDs.size(), TVector3());
+    fMeanPositionEnergy.assign(fMeanPositionVolumeIDs.size(), 0);
+    fTrackPosition.assign(fMeanPositionVolumeIDs.size(), TVector3());
+    fTrackEnergy.assign(fMeanPositionVolumeIDs.size(), 0);
 
-        else if (fDirID[n] == (TString) "Y")
-            mpos = fOutputG4Event->GetMeanPositionInVolume(fVolumeID2[n]).Y();
+    fParticleNumberOfTracks.assign(fParticleNames.size(), 0);
+    fParticleEnergy.assign(fParticleNames.size(), 0);
 
-        else if (fDirID[n] == (TString) "Z")
-            mpos = fOutputG4Event->GetMeanPositionInVolume(fVolumeID2[n]).Z();
+    fContainsProcess.assign(fProcessIDs.size(), false);
 
-        SetObservableValue(obsName, mpos);
-    }
+    fMinX = 1e10;
+    fMaxX = -1e10;
+    fMinY = 1e10;
+    fMaxY = -1e10;
+    fMinZ = 1e10;
+    fMaxZ = -1e10;
+}
 
-    if (GetVerboseLevel() >= TRestStringOutput::REST_Verbose_Level::REST_Debug) {
-        cout << "G4 Tracks : " << fOutputG4Event->GetNumberOfTracks() << endl;
-        cout << "----------------------------" << endl;
+///////////////////////////////////////////////
+/// \brief Computes all the registered quantities of an event in a single pass over its tracks and hits.
+///
+/// The accumulation order is the one of the equivalent TRestGeant4Event methods, so that the results are
+/// identical to theirs, bit by bit.
+///
+void TRestGeant4AnalysisPlan::Fill(const TRestGeant4Event& event) {
+    Reset();
+
+    const Int_t numberOfIndexedVolumes = fMeanPositionSlotByVolumeID.size();
+    size_t numberOfProcessesFound = 0;
+
+    for (const auto& track : event.GetTracks()) {
+        const auto& hits = track.GetHits();
+        for (size_t n = 0; n < hits.GetNumberOfHits(); n++) {
+            const Int_t volumeID = hits.GetVolumeId(n);
+            const Double_t energy = hits.GetEnergy(n);
+
+            if (energy > 0) {
+                const Double_t x = hits.GetX(n);
+                const Double_t y = hits.GetY(n);
+                const Double_t z = hits.GetZ(n);
+
+                if (x > fMaxX) fMaxX = x;
+                if (x < fMinX) fMinX = x;
+                if (y > fMaxY) fMaxY = y;
+                if (y < fMinY) fMinY = y;
+                if (z > fMaxZ) fMaxZ = z;
+                if (z < fMinZ) fMinZ = z;
+
+                if (fSensitiveVolumeID >= 0 && volumeID == fSensitiveVolumeID) {
+                    const Double_t time = hits.GetTime(n);
+                    if (time < fSensitiveVolumeFirstHitTime) {
+                        fSensitiveVolumeFirstHitTime = time;
+                    }
+                    fTrackIDsInSensitiveVolume.insert(track.GetTrackID());
+                }
+            }
+
+            if (volumeID >= 0 && volumeID < numberOfIndexedVolumes) {
+                const Int_t slot = fMeanPositionSlotByVolumeID[volumeID];
+                if (slot >= 0) {
+                    fTrackPosition[slot] += hits.GetPosition(n) * energy;
+                    fTrackEnergy[slot] += energy;
+                }
+            }
+
+            if (numberOfProcessesFound < fProcessIDs.size()) {
+                const Int_t processID = hits.GetProcessId(n);
+                for (size_t slot = 0; slot < fProcessIDs.size(); slot++) {
+                    if (!fContainsProcess[slot] && fProcessIDs[slot] == processID) {
+                        fContainsProcess[slot] = true;
+                        numberOfProcessesFound++;
+                    }
+                }
+            }
+        }
+
+        // the mean position is averaged per track first, as in TRestGeant4Event::GetMeanPositionInVolume
+        for (size_t slot = 0; slot < fTrackEnergy.size(); slot++) {
+            const Double_t trackEnergy = fTrackEnergy[slot];
+            if (trackEnergy > 0) {
+                fMeanPosition[slot] += ((1. / trackEnergy) * fTrackPosition[slot]) * trackEnergy;
+                fMeanPositionEnergy[slot] += trackEnergy;
+            }
+            fTrackPosition[slot] = TVector3();
+            fTrackEnergy[slot] = 0;
+        }
+
+        const Int_t particleID = track.GetParticleID();
+        for (size_t slot = 0; slot < fParticleNames.size(); slot++) {
+            const bool sameParticle = (fParticleIDs[slot] >= 0 && particleID >= 0)
+                                          ? particleID == fParticleIDs[slot]
+                                          : fParticleNames[slot].EqualTo(track.GetParticleName());
+            if (sameParticle) {
+                fParticleNumberOfTracks[slot] += 1;
+                fParticleEnergy[slot] += track.GetTotalEnergy();
+            }
+        }
     }
+}
 
-    return fOutputG4Event;
+///////////////////////////////////////////////
+/// \brief Energy weighted mean position of the hits in the volume registered at `slot`, NaN if there is
+/// no energy deposited in it.
+///
+TVector3 TRestGeant4AnalysisPlan::GetMeanPosition(size_t slot) const {
+    if (fMeanPositionEnergy[slot] == 0) {
+        Double_t nan = TMath::QuietNaN();
+        return {nan, nan, nan};
+    }
+    return (1 / fMeanPositionEnergy[slot]) * fMeanPosition[slot];
 }
 
 ///////////////////////////////////////////////
-/// \brief Function to include required actions after all events have been processed.
-void TRestGeant4AnalysisProcess::EndProcess() {}
+/// \brief Diagonal of the bounding box of the hits with energy, as TRestGeant4Event::GetBoundingBoxSize.
+///
+Double_t TRestGeant4AnalysisPlan::GetBoundingBoxSize() const {
+    Double_t dX = fMaxX - fMinX;
+    Double_t dY = fMaxY - fMinY;
+    Double_t dZ = fMaxZ - fMinZ;
+
+    return TMath::Sqrt(dX * dX + dY * dY + dZ * dZ);
+}
@@ -16,10 +16,62 @@
 
 #include "TRestGeant4BlobAnalysisProcess.h"
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
+
 ClassImp(TRestGeant4BlobAnalysisProcess);
 
 using namespace std;
 
+namespace {
+/// A cubic cell of the grid used to cluster the hits in "clusters" mode
+struct Voxel {
+    Long64_t ix = 0;
+    Long64_t iy = 0;
+    Long64_t iz = 0;
+    /// Energy of the hits inside the voxel
+    Double_t energy = 0;
+    /// Energy weighted position of the hits inside the voxel
+    TVector3 position;
+    /// Sum of energy * squared distance to the voxel position of the hits inside the voxel
+    Double_t secondMoment = 0;
+};
+
+using VoxelKey = std::tuple<Long64_t, Long64_t, Long64_t>;
+
+struct VoxelKeyHash {
+    size_t operator()(const VoxelKey& key) const {
+        // the indices of a track are close to each other, all their bits are mixed into the hash
+        size_t hash = std::hash<Long64_t>()(std::get<0>(key));
+        hash = hash * 1000003 ^ std::hash<Long64_t>()(std::get<1>(key));
+        return hash * 1000003 ^ std::hash<Long64_t>()(std::get<2>(key));
+    }
+};
+
+/// Index of the voxel containing the coordinate. It returns false if the index does not fit in a Long64_t
+/// (with room for the neighbours), for non finite coordinates or a very small voxel size
+inline bool GetVoxelIndex(Double_t coordinate, Double_t voxelSize, Long64_t& index) {
+    constexpr Double_t maxIndex = 4.0e18;
+    const Double_t position = std::floor(coordinate / voxelSize);
+    if (!(std::abs(position) < maxIndex)) {
+        return false;
+    }
+    index = Long64_t(position);
+    return true;
+}
+
+inline size_t FindRoot(std::vector<size_t>& parents, size_t n) {
+    while (parents[n] != n) {
+        parents[n] = parents[parents[n]];
+        n = parents[n];
+    }
+    return n;
+}
+}  // namespace
+
 TRestGeant4BlobAnalysisProcess::TRestGeant4BlobAnalysisProcess() { Initialize(); }
 
 TRestGeant4BlobAnalysisProcess::TRestGeant4BlobAnalysisProcess(const char* configFilename) {
@@ -28,7 +80,7 @@ TRestGeant4BlobAnalysisProcess::TRestGeant4BlobAnalysisProcess(const char* confi
     if (LoadConfigFromFile(configFilename)) LoadDefaultConfig();
 }
 
-TRestGeant4BlobAnalysisProcess::~TRestGeant4BlobAnalysisProcess() { delete fG4Event; }
+TRestGeant4BlobAnalysisProcess::~TRestGeant4BlobAnalysisProcess() = default;
 
 void TRestGeant4BlobAnalysisProcess::LoadDefaultConfig() { SetTitle("Default config"); }
 
@@ -36,8 +88,8 @@ void TRestGeant4BlobAnalysisProcess::Initialize() {
     SetSectionName(this->ClassName());
     SetLibraryVersion(LIBRARY_VERSION);
 
-    fG4Event = new TRestGeant4Event();
-    /// fOutputG4Event = new TRestGeant4Event();
+    // read-only process, the input event is passed through (see ProcessEvent)
+    fG4Event = nullptr;
 }
 
 void TRestGeant4BlobAnalysisProcess::LoadConfig(const string& configFilename, const string& name) {
@@ -63,11 +115,21 @@ void TRestGeant4BlobAnalysisProcess::InitProcess() {
         fQ2_Radius.push_back(r2);
     }
 
+    fBlobObservables.clear();
+    if (fBlobMode == "clusters") {
+        for (int n = 1; n <= fNumberOfBlobs; n++) {
+            const string blob = "blob" + to_string(n) + "_";
+            fBlobObservables.push_back(
+                {blob + "x", blob + "y", blob + "z", blob + "energy", blob + "extent"});
+        }
+    }
+
     fG4Metadata = GetMetadata<TRestGeant4Metadata>();
 }
 
 TRestEvent* TRestGeant4BlobAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
-    *fG4Event = *((TRestGeant4Event*)inputEvent);
+    // the event is not modified, there is no need to copy it
+    fG4Event = (TRestGeant4Event*)inputEvent;
 
     TString obsName;
 
@@ -76,50 +138,79 @@ TRestEvent* TRestGeant4BlobAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
     Double_t xBlob1 = 0, yBlob1 = 0, zBlob1 = 0;
     Double_t xBlob2 = 0, yBlob2 = 0, zBlob2 = 0;
 
-    for (unsigned int tck = 0; tck < fG4Event->GetNumberOfTracks(); tck++) {
-        const auto& track = fG4Event->GetTrack(tck);
-        if (track.GetParentID() == 0) {
-            if (track.GetParticleName() != "e-") {
-                cout << "TRestGeant4BlobAnalysis Warning. Primary particle is not an "
-                        "electron!!"
-                     << endl;
-                cout << "Skipping." << endl;
-                continue;
-            }
-
-            if (track.GetNumberOfHits() == 0) {
-                cout << "REST. FindG4Blobs WARNING. A primary electron with no hits "
-                        "was found!!"
-                     << endl;
-                cout << "Skipping." << endl;
-                continue;
-            }
-
-            if (nBlobs >= 2) {
-                cout << "TRestGeant4BlobAnalysis Warning. More than 2 e- primaries "
-                        "found!"
-                     << endl;
-                continue;
-            }
-
-            Int_t nHits = track.GetNumberOfHits();
-
-            if (nBlobs == 0) {
-                xBlob1 = track.GetHits().GetX(nHits - 1);
-                yBlob1 = track.GetHits().GetY(nHits - 1);
-                zBlob1 = track.GetHits().GetZ(nHits - 1);
-            } else {
-                xBlob2 = track.GetHits().GetX(nHits - 1);
-                yBlob2 = track.GetHits().GetY(nHits - 1);
-                zBlob2 = track.GetHits().GetZ(nHits - 1);
+    if (fBlobMode == "clusters") {
+        Int_t numberOfClusters = 0;
+        const auto blobs = FindBlobs(*fG4Event, numberOfClusters);
+        nBlobs = blobs.size();
+
+        for (size_t n = 0; n < fBlobObservables.size(); n++) {
+            const TRestGeant4Blob blob = n < blobs.size() ? blobs[n] : TRestGeant4Blob();
+            SetObservableValue(fBlobObservables[n][0], blob.position.X());
+            SetObservableValue(fBlobObservables[n][1], blob.position.Y());
+            SetObservableValue(fBlobObservables[n][2], blob.position.Z());
+            SetObservableValue(fBlobObservables[n][3], blob.energy);
+            SetObservableValue(fBlobObservables[n][4], blob.extent);
+        }
+        SetObservableValue("nBlobs", nBlobs);
+        SetObservableValue("nClusters", numberOfClusters);
+
+        // the two most energetic blobs are used for the two blobs observables
+        if (blobs.size() > 0) {
+            xBlob1 = blobs[0].position.X();
+            yBlob1 = blobs[0].position.Y();
+            zBlob1 = blobs[0].position.Z();
+        }
+        if (blobs.size() > 1) {
+            xBlob2 = blobs[1].position.X();
+            yBlob2 = blobs[1].position.Y();
+            zBlob2 = blobs[1].position.Z();
+        }
+    } else {
+        for (unsigned int tck = 0; tck < fG4Event->GetNumberOfTracks(); tck++) {
+            const auto& track = fG4Event->GetTrack(tck);
+            if (track.GetParentID() == 0) {
+                if (track.GetParticleName() != "e-") {
+                    cout << "TRestGeant4BlobAnalysis Warning. Primary particle is not an "
+                            "electron!!"
+                         << endl;
+                    cout << "Skipping." << endl;
+                    continue;
+                }
+
+                if (track.GetNumberOfHits() == 0) {
+                    cout << "REST. FindG4Blobs WARNING. A primary electron with no hits "
+                            "was found!!"
+                         << endl;
+                    cout << "Skipping." << endl;
+                    continue;
+                }
+
+                if (nBlobs >= 2) {
+                    cout << "TRestGeant4BlobAnalysis Warning. More than 2 e- primaries "
+                            "found!"
+                         << endl;
+                    continue;
+                }
+
+                Int_t nHits = track.GetNumberOfHits();
+
+                if (nBlobs == 0) {
+                    xBlob1 = track.GetHits().GetX(nHits - 1);
+                    yBlob1 = track.GetHits().GetY(nHits - 1);
+                    zBlob1 = track.GetHits().GetZ(nHits - 1);
+                } else {
+                    xBlob2 = track.GetHits().GetX(nHits - 1);
+                    yBlob2 = track.GetHits().GetY(nHits - 1);
+                    zBlob2 = track.GetHits().GetZ(nHits - 1);
+                }
+
+                nBlobs++;
             }
-
-            nBlobs++;
         }
-    }
 
-    if (nBlobs != 2) {
-        cout << "REST. FindG4Blobs ERROR. Blobs != 2. Blobs found " << nBlobs << endl;
+        if (nBlobs != 2) {
+            cout << "REST. FindG4Blobs ERROR. Blobs != 2. Blobs found " << nBlobs << endl;
+        }
     }
 
     // The blob with z-coordinate closer to z=0 is stored in x1,y1,z1
@@ -165,19 +256,17 @@ TRestEvent* TRestGeant4BlobAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
 
     SetObservableValue("distance", blobDistance);
 
-    /// We get the energy of the blobs
-    TRestHits hits = fG4Event->GetHits();
+    /// We get the energy of the blobs, all the radii of each blob in a single pass over the hits
+    const auto hits = fG4Event->GetHitsView();
 
+    const auto q1 = hits.GetEnergyInSpheres(x1, y1, z1, fQ1_Radius);
     for (unsigned int n = 0; n < fQ1_Observables.size(); n++) {
-        Double_t q = hits.GetEnergyInSphere(x1, y1, z1, fQ1_Radius[n]);
-
-        SetObservableValue(fQ1_Observables[n], q);
+        SetObservableValue(fQ1_Observables[n], q1[n]);
     }
 
+    const auto q2 = hits.GetEnergyInSpheres(x2, y2, z2, fQ2_Radius);
     for (unsigned int n = 0; n < fQ2_Observables.size(); n++) {
-        Double_t q = hits.GetEnergyInSphere(x2, y2, z2, fQ2_Radius[n]);
-
-        SetObservableValue(fQ2_Observables[n], q);
+        SetObservableValue(fQ2_Observables[n], q2[n]);
     }
 
     return fG4Event;
@@ -192,4 +281,173 @@ void TRestGeant4BlobAnalysisProcess::EndProcess() {
     // TRestEventProcess::EndProcess();
 }
 
-void TRestGeant4BlobAnalysisProcess::InitFromConfigFile() {}
+///////////////////////////////////////////////
+/// \brief It finds the fNumberOfBlobs densest regions of the event, in decreasing order of energy.
+///
+/// The hits above fMinimumHitEnergy are binned in a grid of cubic voxels of size fVoxelSize. The density
+/// of a voxel is the energy inside it and its 26 neighbours. Every voxel denser than all its neighbours is
+/// a blob candidate, made of the voxels in its neighbourhood which are not in a denser candidate, so that
+/// the energy of a voxel is never counted twice. The energy, position and extent of a blob are the ones
+/// of the hits in its voxels. This favours the dense end-points of the tracks regardless of the particles
+/// involved. The voxels touching each other are also grouped into clusters, so that separate deposits
+/// (e.g. multi-site events) can be told apart. The cost is linear in the number of hits.
+///
+std::vector<TRestGeant4Blob> TRestGeant4BlobAnalysisProcess::FindBlobs(const TRestGeant4Event& event,
+                                                                       Int_t& numberOfClusters) const {
+    std::vector<Voxel> voxels;
+    std::unordered_map<VoxelKey, size_t, VoxelKeyHash> voxelIndices;
+    // voxel of each hit, in the order of the hits view, -1 for the hits which are not used
+    std::vector<Long64_t> hitVoxels;
+
+    const auto hits = event.GetHitsView(-1, fMinimumHitEnergy);
+    for (const auto& hit : hits) {
+        const Double_t energy = hit.GetEnergy();
+        Long64_t ix, iy, iz;
+        if (energy <= 0 || !GetVoxelIndex(hit.GetX(), fVoxelSize, ix) ||
+            !GetVoxelIndex(hit.GetY(), fVoxelSize, iy) || !GetVoxelIndex(hit.GetZ(), fVoxelSize, iz)) {
+            hitVoxels.push_back(-1);
+            continue;
+        }
+        const auto [it, inserted] = voxelIndices.emplace(VoxelKey(ix, iy, iz), voxels.size());
+        if (inserted) {
+            voxels.emplace_back();
+            voxels.back().ix = ix;
+            voxels.back().iy = iy;
+            voxels.back().iz = iz;
+        }
+        Voxel& voxel = voxels[it->second];
+        voxel.energy += energy;
+        voxel.position += energy * hit.GetPosition();
+        hitVoxels.push_back(it->second);
+    }
+    for (auto& voxel : voxels) {
+        voxel.position *= 1.0 / voxel.energy;
+    }
+    // the spread is computed around the voxel positions, which is numerically stable
+    size_t hitIndex = 0;
+    for (const auto& hit : hits) {
+        const Long64_t voxelIndex = hitVoxels[hitIndex++];
+        if (voxelIndex < 0) {
+            continue;
+        }
+        Voxel& voxel = voxels[voxelIndex];
+        voxel.secondMoment += hit.GetEnergy() * (hit.GetPosition() - voxel.position).Mag2();
+    }
+
+    const auto forEachNeighbour = [&voxels, &voxelIndices](size_t n, const auto& function) {
+        const Voxel& voxel = voxels[n];
+        for (int dx = -1; dx <= 1; dx++) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dz = -1; dz <= 1; dz++) {
+                    const auto it = voxelIndices.find(VoxelKey(voxel.ix + dx, voxel.iy + dy, voxel.iz + dz));
+                    if (it != voxelIndices.end()) {
+                        function(it->second);
+                    }
+                }
+            }
+        }
+    };
+
+    // densities and clusters of connected voxels
+    std::vector<Double_t> densities(voxels.size(), 0);
+    std::vector<size_t> parents(voxels.size());
+    std::iota(parents.begin(), parents.end(), 0);
+    for (size_t n = 0; n < voxels.size(); n++) {
+        forEachNeighbour(n, [&](size_t neighbour) {
+            densities[n] += voxels[neighbour].energy;
+            parents[FindRoot(parents, neighbour)] = FindRoot(parents, n);
+        });
+    }
+
+    std::vector<Int_t> clusters(voxels.size(), -1);
+    numberOfClusters = 0;
+    for (size_t n = 0; n < voxels.size(); n++) {
+        const size_t root = FindRoot(parents, n);
+        if (clusters[root] == -1) {
+            clusters[root] = numberOfClusters++;
+        }
+        clusters[n] = clusters[root];
+    }
+
+    // local density maxima, ties are broken by voxel index
+    std::vector<size_t> maxima;
+    for (size_t n = 0; n < voxels.size(); n++) {
+        bool isMaximum = true;
+        forEachNeighbour(n, [&](size_t neighbour) {
+            if (densities[neighbour] > densities[n] ||
+                (densities[neighbour] == densities[n] && neighbour < n)) {
+                isMaximum = false;
+            }
+        });
+        if (isMaximum) {
+            maxima.push_back(n);
+        }
+    }
+    std::sort(maxima.begin(), maxima.end(), [&densities](size_t a, size_t b) {
+        return densities[a] > densities[b] || (densities[a] == densities[b] && a < b);
+    });
+
+    // the neighbourhoods of two maxima may overlap, each voxel goes to the densest maximum next to it so
+    // that no energy is counted in two blobs. Two maxima are never neighbours, each keeps its own voxel
+    std::vector<Int_t> voxelBlobs(voxels.size(), -1);
+    std::vector<TRestGeant4Blob> blobs(maxima.size());
+    for (size_t blobIndex = 0; blobIndex < maxima.size(); blobIndex++) {
+        TRestGeant4Blob& blob = blobs[blobIndex];
+        blob.cluster = clusters[maxima[blobIndex]];
+        forEachNeighbour(maxima[blobIndex], [&](size_t neighbour) {
+            if (voxelBlobs[neighbour] == -1) {
+                voxelBlobs[neighbour] = blobIndex;
+                blob.energy += voxels[neighbour].energy;
+                blob.position += voxels[neighbour].energy * voxels[neighbour].position;
+            }
+        });
+        blob.position *= 1.0 / blob.energy;
+    }
+    std::vector<Double_t> secondMoments(blobs.size(), 0);
+    for (size_t n = 0; n < voxels.size(); n++) {
+        if (voxelBlobs[n] != -1) {
+            const Voxel& voxel = voxels[n];
+            secondMoments[voxelBlobs[n]] +=
+                voxel.secondMoment + voxel.energy * (voxel.position - blobs[voxelBlobs[n]].position).Mag2();
+        }
+    }
+    for (size_t blobIndex = 0; blobIndex < blobs.size(); blobIndex++) {
+        blobs[blobIndex].extent = TMath::Sqrt(secondMoments[blobIndex] / blobs[blobIndex].energy);
+    }
+
+    std::stable_sort(blobs.begin(), blobs.end(),
+                     [](const TRestGeant4Blob& a, const TRestGeant4Blob& b) { return a.energy > b.energy; });
+    if (blobs.size() > size_t(fNumberOfBlobs)) {
+        blobs.resize(fNumberOfBlobs);
+    }
+
+    return blobs;
+}
+
+///////////////////////////////////////////////
+/// \brief Function to read the input parameters.
+///
+/// * **blobMode**: "electrons" (default) takes the end-points of the two primary electrons as blobs.
+/// "clusters" finds the densest regions of the event, see FindBlobs, and defines the observables
+/// `nBlobs`, `nClusters` and `blob<n>_x`, `blob<n>_y`, `blob<n>_z`, `blob<n>_energy`, `blob<n>_extent`.
+/// * **numberOfBlobs**: number of blobs searched in "clusters" mode (default 2).
+/// * **voxelSize**: size (mm) of the clustering voxels in "clusters" mode (default 1).
+/// * **minimumHitEnergy**: hits below this energy (keV) are ignored in "clusters" mode (default 0).
+///
+void TRestGeant4BlobAnalysisProcess::InitFromConfigFile() {
+    fBlobMode = GetParameter("blobMode", "electrons");
+    if (fBlobMode != "electrons" && fBlobMode != "clusters") {
+        RESTError << "TRestGeant4BlobAnalysisProcess: unknown blobMode '" << fBlobMode
+                  << "'. Valid modes are 'electrons' and 'clusters'" << RESTendl;
+        exit(1);
+    }
+
+    fNumberOfBlobs = StringToInteger(GetParameter("numberOfBlobs", "2"));
+    fVoxelSize = StringToDouble(GetParameter("voxelSize", "1"));
+    fMinimumHitEnergy = StringToDouble(GetParameter("minimumHitEnergy", "0"));
+    if (fNumberOfBlobs < 1 || fVoxelSize <= 0) {
+        RESTError << "TRestGeant4BlobAnalysisProcess: numberOfBlobs and voxelSize must be positive"
+                  << RESTendl;
+        exit(1);
+    }
+}
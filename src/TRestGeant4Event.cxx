@@ -17,11 +17,16 @@
 
 #include "TRestGeant4Event.h"
 
+#include <TBranch.h>
 #include <TFrame.h>
 #include <TRestRun.h>
 #include <TRestStringHelper.h>
 #include <TRestTools.h>
 #include <TStyle.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <numeric>
 
 #include "TRestGeant4Metadata.h"
 
@@ -36,6 +41,33 @@ TRestGeant4Event::TRestGeant4Event() {
     Initialize();
 }
 
+TRestGeant4Event::TRestGeant4Event(const TRestGeant4Event& event) : TRestGeant4Event() { *this = event; }
+
+///////////////////////////////////////////////
+/// \brief Completes the default assignment of an event, which has already copied the tracks. If the
+/// hits of the source are pending (see SetHitsLazyLoading) they are read and the tracks copied again.
+/// The copied tracks and hits are linked to the destination, which keeps its own read settings.
+///
+TRestGeant4Event::HitsReading& TRestGeant4Event::HitsReading::operator=(const HitsReading& reading) {
+    if (reading.fPending) {
+        reading.fOwner->LoadHits();
+        fOwner->fTracks = reading.fOwner->fTracks;
+    }
+    fPending = false;
+    fOwner->LinkTracks();
+    return *this;
+}
+
+/// Links the tracks (and their hits) to this event, the tracks hold pointers to it
+void TRestGeant4Event::LinkTracks() {
+    for (auto& track : fTracks) {
+        track.SetEvent(this);
+        track.fHits.SetTrack(&track);
+        track.fHits.SetEvent(this);
+        track.fHitsPending = fHitsReading.fPending;
+    }
+}
+
 TRestGeant4Event::~TRestGeant4Event() {
     // TRestGeant4Event destructor
 }
@@ -44,8 +76,17 @@ void TRestGeant4Event::Initialize() {
     TRestEvent::Initialize();
 
     fPrimaryParticleNames.clear();
+    fPrimaryEnergies.clear();
+    fPrimaryDirections.clear();
 
     fTracks.clear();
+    fHitsColumns.Clear();
+    ClearEnergyDeposits();
+    fEnergyInVolumeIndexValid = false;
+    ResetTrackIDIndex();
+    fTrackIDToTrackIndex.clear();
+    fGenealogyValid = false;
+    fProcessOccurrencesValid = false;
 
     // ClearVolumes();
     fXZHitGraph = nullptr;
@@ -138,14 +179,12 @@ TVector3 TRestGeant4Event::GetPositionDeviationInVolume(Int_t volID) const {
     Double_t nan = TMath::QuietNaN();
     if (meanPos == TVector3(nan, nan, nan)) return TVector3(nan, nan, nan);
 
-    TRestHits hitsInVolume = GetHitsInVolume(volID);
-
     Double_t edep = 0;
     TVector3 deviation = TVector3(0, 0, 0);
 
-    for (unsigned int n = 0; n < hitsInVolume.GetNumberOfHits(); n++) {
-        Double_t en = hitsInVolume.GetEnergy(n);
-        TVector3 diff = meanPos - hitsInVolume.GetPosition(n);
+    for (const auto& hit : GetHitsView(volID)) {
+        Double_t en = hit.GetEnergy();
+        TVector3 diff = meanPos - hit.GetPosition();
         diff.SetXYZ(diff.X() * diff.X(), diff.Y() * diff.Y(), diff.Z() * diff.Z());
 
         deviation = deviation + en * diff;
@@ -190,24 +229,282 @@ TVector3 TRestGeant4Event::GetLastPositionInVolume(Int_t volID) const {
     return {nan, nan, nan};
 }
 
+///////////////////////////////////////////////
+/// \brief Returns a pointer to the track with the given track ID, or nullptr if there is no such track.
+///
+/// The lookup uses a transient index which is rebuilt in InitializeReferences and extended on demand
+/// when new tracks are appended to the event.
+///
 TRestGeant4Track* TRestGeant4Event::GetTrackByID(Int_t trackID) const {
-    TRestGeant4Track* result = nullptr;
-    if (fTrackIDToTrackIndex.count(trackID) > 0) {
-        result = const_cast<TRestGeant4Track*>(&fTracks[fTrackIDToTrackIndex.at(trackID)]);
-        if (result == nullptr || result->GetTrackID() != trackID) {
-            cerr << "TRestGeant4Event::GetTrackByID - ERROR: trackIDToTrackIndex map is corrupted" << endl;
-            exit(1);
+    if (fNumberOfIndexedTracks != fTracks.size()) {
+        UpdateTrackIDIndex();
+    }
+
+    Int_t trackIndex = -1;
+    if (fTrackIndexIsSparse) {
+        const auto it = fTrackIndexByIDSparse.find(trackID);
+        if (it != fTrackIndexByIDSparse.end()) {
+            trackIndex = it->second;
         }
+    } else if (trackID >= fLowestTrackID && trackID - fLowestTrackID < Int_t(fTrackIndexByID.size())) {
+        trackIndex = fTrackIndexByID[trackID - fLowestTrackID];
+    }
+
+    if (trackIndex < 0) {
+        return nullptr;
+    }
+    TRestGeant4Track* result = const_cast<TRestGeant4Track*>(&fTracks[trackIndex]);
+    if (result->GetTrackID() != trackID) {
+        cerr << "TRestGeant4Event::GetTrackByID - ERROR: track ID index is corrupted" << endl;
+        exit(1);
     }
     return result;
 }
 
+///////////////////////////////////////////////
+/// \brief Returns the energy deposited in the given volume by track `n` and all its descendants.
+///
+Double_t TRestGeant4Event::GetEnergyInVolumeInSubtree(size_t n, Int_t volumeID) const {
+    UpdateGenealogy();
+    Double_t energy = 0;
+    for (Int_t position = fTrackPreOrder[n]; position < fTrackPostOrder[n]; position++) {
+        energy += fTracks[fTracksInPreOrder[position]].GetEnergyInVolume(volumeID);
+    }
+    return energy;
+}
+
+///////////////////////////////////////////////
+/// \brief Computes the parent index, depth and Euler tour (pre/post order) of every track.
+///
+/// Tracks whose parent is not stored in the event are treated as roots. Children are visited in the
+/// order they appear in the track list, so the traversal is deterministic.
+///
+void TRestGeant4Event::BuildGenealogy() const {
+    const size_t numberOfTracks = fTracks.size();
+
+    fParentTrackIndex.assign(numberOfTracks, -1);
+    fTrackDepth.assign(numberOfTracks, 0);
+    fTrackPreOrder.assign(numberOfTracks, -1);
+    fTrackPostOrder.assign(numberOfTracks, -1);
+    fTracksInPreOrder.clear();
+    fTracksInPreOrder.reserve(numberOfTracks);
+
+    // children of each track stored contiguously (compressed sparse row)
+    vector<Int_t> childrenOffset(numberOfTracks + 1, 0);
+    for (size_t n = 0; n < numberOfTracks; n++) {
+        const TRestGeant4Track* parent = GetTrackByID(fTracks[n].GetParentID());
+        if (parent != nullptr && parent != &fTracks[n]) {
+            fParentTrackIndex[n] = Int_t(parent - fTracks.data());
+            childrenOffset[fParentTrackIndex[n] + 1]++;
+        }
+    }
+    for (size_t n = 0; n < numberOfTracks; n++) {
+        childrenOffset[n + 1] += childrenOffset[n];
+    }
+    vector<Int_t> children(childrenOffset.back());
+    vector<Int_t> childrenFilled(childrenOffset.begin(), childrenOffset.end() - 1);
+    for (size_t n = 0; n < numberOfTracks; n++) {
+        if (fParentTrackIndex[n] >= 0) {
+            children[childrenFilled[fParentTrackIndex[n]]++] = Int_t(n);
+        }
+    }
+
+    // iterative depth-first traversal, each stack entry is a track and the next child to visit
+    vector<pair<Int_t, Int_t>> stack;
+    auto visit = [&](Int_t trackIndex, Int_t depth) {
+        fTrackDepth[trackIndex] = depth;
+        fTrackPreOrder[trackIndex] = Int_t(fTracksInPreOrder.size());
+        fTracksInPreOrder.push_back(trackIndex);
+        stack.emplace_back(trackIndex, childrenOffset[trackIndex]);
+    };
+
+    // first pass starts from the tracks without parent, the second one only from tracks left unvisited
+    // because of a broken parent chain
+    for (int pass = 0; pass < 2; pass++) {
+        for (size_t root = 0; root < numberOfTracks; root++) {
+            if (fTrackPreOrder[root] >= 0 || (pass == 0 && fParentTrackIndex[root] >= 0)) {
+                continue;
+            }
+            visit(Int_t(root), 0);
+            while (!stack.empty()) {
+                const Int_t trackIndex = stack.back().first;
+                const Int_t nextChild = stack.back().second;
+                if (nextChild == childrenOffset[trackIndex + 1]) {
+                    fTrackPostOrder[trackIndex] = Int_t(fTracksInPreOrder.size());
+                    stack.pop_back();
+                    continue;
+                }
+                stack.back().second++;
+                const Int_t child = children[nextChild];
+                if (fTrackPreOrder[child] < 0) {
+                    visit(child, fTrackDepth[trackIndex] + 1);
+                }
+            }
+        }
+    }
+
+    fGenealogyValid = true;
+}
+
+///////////////////////////////////////////////
+/// \brief Enables or disables the lazy loading of the hits when the event is read from a TRestRun.
+///
+/// When enabled, the branches holding the hits of the tracks are disabled in the event tree, so that
+/// reading an entry only reads the track headers (particle, parent, creator process, energy...). The
+/// hits of the entry are read the first time they are accessed through TRestGeant4Track::GetHits or
+/// any method using them. Analyses which never touch the hits never read their baskets.
+///
+/// This requires the event branch to be split (the default when TRestRun writes the events), so that
+/// the hits are stored in their own branches. Otherwise it has no effect.
+///
+/// It must be called after TRestRun::SetInputEvent, and before reading entries.
+///
+void TRestGeant4Event::SetHitsLazyLoading(Bool_t enable) {
+    if (!enable && fHitsReading.fTree != nullptr) {
+        for (const auto& branch : fHitsReading.fBranches) {
+            fHitsReading.fTree->SetBranchStatus(branch->GetName(), true);
+        }
+    }
+    fHitsReading.fLazyLoading = enable;
+    fHitsReading.fTree = nullptr;
+    fHitsReading.fBranches.clear();
+}
+
+namespace {
+void CollectHitsBranches(TObjArray* branches, vector<TBranch*>& hitsBranches) {
+    if (branches == nullptr) {
+        return;
+    }
+    for (int n = 0; n < branches->GetEntries(); n++) {
+        auto branch = (TBranch*)branches->At(n);
+        if (TString(branch->GetName()).Contains("fTracks.fHits")) {
+            hitsBranches.push_back(branch);
+            continue;
+        }
+        CollectHitsBranches(branch->GetListOfBranches(), hitsBranches);
+    }
+}
+}  // namespace
+
+void TRestGeant4Event::BindHitsBranches(TTree* tree) {
+    fHitsReading.fTree = tree;
+    fHitsReading.fBranches.clear();
+    if (tree == nullptr) {
+        return;
+    }
+    CollectHitsBranches(tree->GetListOfBranches(), fHitsReading.fBranches);
+    if (fHitsReading.fBranches.empty()) {
+        RESTWarning << "TRestGeant4Event::SetHitsLazyLoading - the hits are not stored in separate branches, "
+                       "they will be read with the tracks"
+                    << RESTendl;
+        return;
+    }
+    for (const auto& branch : fHitsReading.fBranches) {
+        tree->SetBranchStatus(branch->GetName(), false);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief Reads the hits of the current entry if they have not been read yet (see SetHitsLazyLoading).
+///
+void TRestGeant4Event::LoadHits() const {
+    if (!fHitsReading.fPending) {
+        return;
+    }
+    fHitsReading.fPending = false;
+    for (const auto& branch : fHitsReading.fBranches) {
+        // branches are disabled in the tree, 'getall' is needed to read them
+        branch->GetEntry(fHitsReading.fEntry, 1);
+    }
+    for (auto& track : const_cast<vector<TRestGeant4Track>&>(fTracks)) {
+        track.fHitsPending = false;
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief Converts the hits of all the tracks into the compact storage form (see
+/// TRestGeant4Hits::Compact). It should be called right before writing the event.
+///
+/// \return false if the hits of any track could not be compacted, those hits are left unchanged.
+///
+Bool_t TRestGeant4Event::CompactHits(Int_t positionMantissaBits, Int_t timeMantissaBits) {
+    Bool_t compacted = true;
+    for (auto& track : fTracks) {
+        if (!track.GetHitsPointer()->Compact(positionMantissaBits, timeMantissaBits)) {
+            compacted = false;
+        }
+    }
+    return compacted;
+}
+
+void TRestGeant4Event::ResetTrackIDIndex() const {
+    fTrackIndexByID.clear();
+    fTrackIndexByIDSparse.clear();
+    fLowestTrackID = 0;
+    fTrackIndexIsSparse = false;
+    fNumberOfIndexedTracks = 0;
+}
+
+void TRestGeant4Event::UpdateTrackIDIndex() const {
+    if (fNumberOfIndexedTracks > fTracks.size()) {
+        // tracks have been removed, index them again from scratch
+        ResetTrackIDIndex();
+    }
+    for (size_t trackIndex = fNumberOfIndexedTracks; trackIndex < fTracks.size(); trackIndex++) {
+        AddTrackToIDIndex(fTracks[trackIndex].GetTrackID(), Int_t(trackIndex));
+    }
+    fNumberOfIndexedTracks = fTracks.size();
+}
+
+void TRestGeant4Event::AddTrackToIDIndex(Int_t trackID, Int_t trackIndex) const {
+    if (fTrackIndexIsSparse) {
+        fTrackIndexByIDSparse[trackID] = trackIndex;
+        return;
+    }
+
+    if (fTrackIndexByID.empty()) {
+        fLowestTrackID = trackID;
+    }
+    const Int_t lowestTrackID = std::min(fLowestTrackID, trackID);
+    const Int_t highestTrackID = std::max(fLowestTrackID + Int_t(fTrackIndexByID.size()) - 1, trackID);
+    const size_t range = size_t(highestTrackID - lowestTrackID) + 1;
+
+    // Geant4 track IDs are nearly contiguous, if they are not the dense index would waste memory
+    if (range > 2 * size_t(trackIndex + 1) + 1024) {
+        for (size_t n = 0; n < fTrackIndexByID.size(); n++) {
+            if (fTrackIndexByID[n] >= 0) {
+                fTrackIndexByIDSparse[fLowestTrackID + Int_t(n)] = fTrackIndexByID[n];
+            }
+        }
+        fTrackIndexByID.clear();
+        fTrackIndexIsSparse = true;
+        fTrackIndexByIDSparse[trackID] = trackIndex;
+        return;
+    }
+
+    if (lowestTrackID < fLowestTrackID) {
+        fTrackIndexByID.insert(fTrackIndexByID.begin(), fLowestTrackID - lowestTrackID, -1);
+        fLowestTrackID = lowestTrackID;
+    }
+    if (range > fTrackIndexByID.size()) {
+        fTrackIndexByID.resize(range, -1);
+    }
+    fTrackIndexByID[trackID - fLowestTrackID] = trackIndex;
+}
+
 ///////////////////////////////////////////////
 /// \brief Function that returns the total number of hits in the Geant4 event. If
 /// a specific volume is given as argument only the hits of that specific volume
 /// will be counted.
 ///
 size_t TRestGeant4Event::GetNumberOfHits(Int_t volID) const {
+    if (HasHitsColumns()) {
+        if (volID == -1) {
+            return fHitsColumns.GetNumberOfHits();
+        }
+        return std::count(fHitsColumns.fVolumeID.begin(), fHitsColumns.fVolumeID.end(), volID);
+    }
+
     size_t numberOfHits = 0;
     for (const auto& track : fTracks) {
         numberOfHits += track.GetNumberOfHits(volID);
@@ -222,6 +519,19 @@ size_t TRestGeant4Event::GetNumberOfHits(Int_t volID) const {
 ///
 size_t TRestGeant4Event::GetNumberOfPhysicalHits(Int_t volID) const {
     size_t numberOfHits = 0;
+    if (HasHitsColumns()) {
+        for (size_t n = 0; n < fHitsColumns.GetNumberOfHits(); n++) {
+            if (volID != -1 && fHitsColumns.fVolumeID[n] != volID) {
+                continue;
+            }
+            if (fHitsColumns.fEnergy[n] <= 0) {
+                continue;
+            }
+            numberOfHits++;
+        }
+        return numberOfHits;
+    }
+
     for (const auto& track : fTracks) {
         numberOfHits += track.GetNumberOfPhysicalHits(volID);
     }
@@ -235,6 +545,16 @@ size_t TRestGeant4Event::GetNumberOfPhysicalHits(Int_t volID) const {
 ///
 TRestHits TRestGeant4Event::GetHits(Int_t volID) const {
     TRestHits hits;
+    if (HasHitsColumns()) {
+        for (size_t n = 0; n < fHitsColumns.GetNumberOfHits(); n++) {
+            if (volID != -1 && fHitsColumns.fVolumeID[n] != volID) continue;
+
+            hits.AddHit({fHitsColumns.fX[n], fHitsColumns.fY[n], fHitsColumns.fZ[n]},
+                        fHitsColumns.fEnergy[n]);
+        }
+        return hits;
+    }
+
     for (unsigned int t = 0; t < GetNumberOfTracks(); t++) {
         const auto& g4Hits = GetTrack(t).GetHits();
         for (unsigned int n = 0; n < g4Hits.GetNumberOfHits(); n++) {
@@ -252,7 +572,52 @@ TRestHits TRestGeant4Event::GetHits(Int_t volID) const {
     return hits;
 }
 
+///////////////////////////////////////////////
+/// \brief Returns the ID of the particle in TRestGeant4PhysicsInfo, or -1 if the tracks have no particle
+/// IDs (no metadata bound) or the particle is not known.
+///
+Int_t TRestGeant4Event::GetParticleIDFromName(const TString& particleName) const {
+    if (fGeant4Metadata == nullptr) {
+        return -1;
+    }
+    return fGeant4Metadata->GetGeant4PhysicsInfo().FindParticleID(particleName);
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the number of tracks of a particle given its ID in TRestGeant4PhysicsInfo. Negative IDs
+/// (unknown particles) match no track, even if the tracks have no particle IDs themselves.
+///
+Int_t TRestGeant4Event::GetNumberOfTracksForParticle(Int_t particleID) const {
+    if (particleID < 0) {
+        return 0;
+    }
+    Int_t nTracks = 0;
+    for (const auto& track : fTracks) {
+        if (track.GetParticleID() == particleID) {
+            nTracks += 1;
+        }
+    }
+    return nTracks;
+}
+
+Double_t TRestGeant4Event::GetEnergyDepositedByParticle(Int_t particleID) const {
+    if (particleID < 0) {
+        return 0;
+    }
+    Double_t energy = 0;
+    for (const auto& track : fTracks) {
+        if (track.GetParticleID() == particleID) {
+            energy += track.GetTotalEnergy();
+        }
+    }
+    return energy;
+}
+
 Int_t TRestGeant4Event::GetNumberOfTracksForParticle(const TString& particleName) const {
+    const Int_t particleID = GetParticleIDFromName(particleName);
+    if (particleID >= 0) {
+        return GetNumberOfTracksForParticle(particleID);
+    }
     Int_t nTracks = 0;
     for (const auto& track : fTracks) {
         if (particleName.EqualTo(track.GetParticleName())) {
@@ -263,6 +628,10 @@ Int_t TRestGeant4Event::GetNumberOfTracksForParticle(const TString& particleName
 }
 
 Double_t TRestGeant4Event::GetEnergyDepositedByParticle(const TString& particleName) const {
+    const Int_t particleID = GetParticleIDFromName(particleName);
+    if (particleID >= 0) {
+        return GetEnergyDepositedByParticle(particleID);
+    }
     Double_t energy = 0;
     for (const auto& track : fTracks) {
         if (particleName.EqualTo(track.GetParticleName())) {
@@ -305,7 +674,30 @@ void TRestGeant4Event::SetBoundaries() {
     Double_t minEnergy = 1e10, maxEnergy = -1e10;
 
     Int_t nTHits = 0;
-    for (unsigned int ntck = 0; ntck < this->GetNumberOfTracks(); ntck++) {
+    if (HasHitsColumns()) {
+        nTHits = fHitsColumns.GetNumberOfHits();
+        for (int nhit = 0; nhit < nTHits; nhit++) {
+            Double_t en = fHitsColumns.fEnergy[nhit];
+
+            if (en <= 0) continue;
+
+            Double_t x = fHitsColumns.fX[nhit];
+            Double_t y = fHitsColumns.fY[nhit];
+            Double_t z = fHitsColumns.fZ[nhit];
+
+            if (x > maxX) maxX = x;
+            if (x < minX) minX = x;
+            if (y > maxY) maxY = y;
+            if (y < minY) minY = y;
+            if (z > maxZ) maxZ = z;
+            if (z < minZ) minZ = z;
+
+            if (en > maxEnergy) maxEnergy = en;
+            if (en < minEnergy) minEnergy = en;
+        }
+    }
+
+    for (unsigned int ntck = 0; !HasHitsColumns() && ntck < this->GetNumberOfTracks(); ntck++) {
         Int_t nHits = GetTrack(ntck).GetNumberOfHits();
         nTHits += nHits;
         const auto& hits = GetTrack(ntck).GetHits();
@@ -1216,7 +1608,38 @@ Bool_t TRestGeant4Event::ContainsProcessInVolume(const TString& processName, Int
     return false;
 }
 
+Bool_t TRestGeant4Event::ContainsParticle(Int_t particleID) const {
+    if (particleID < 0) {
+        return false;
+    }
+    for (const auto& track : fTracks) {
+        if (track.GetParticleID() == particleID) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Bool_t TRestGeant4Event::ContainsParticleInVolume(Int_t particleID, Int_t volumeID) const {
+    if (particleID < 0) {
+        return false;
+    }
+    for (const auto& track : fTracks) {
+        if (track.GetParticleID() != particleID) {
+            continue;
+        }
+        if (track.GetHits().GetNumberOfHitsInVolume(volumeID) > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 Bool_t TRestGeant4Event::ContainsParticle(const TString& particleName) const {
+    const Int_t particleID = GetParticleIDFromName(particleName);
+    if (particleID >= 0) {
+        return ContainsParticle(particleID);
+    }
     for (const auto& track : fTracks) {
         if (track.GetParticleName() == particleName) {
             return true;
@@ -1226,6 +1649,10 @@ Bool_t TRestGeant4Event::ContainsParticle(const TString& particleName) const {
 }
 
 Bool_t TRestGeant4Event::ContainsParticleInVolume(const TString& particleName, Int_t volumeID) const {
+    const Int_t particleID = GetParticleIDFromName(particleName);
+    if (particleID >= 0) {
+        return ContainsParticleInVolume(particleID, volumeID);
+    }
     for (const auto& track : fTracks) {
         if (track.GetParticleName() != particleName) {
             continue;
@@ -1238,6 +1665,9 @@ Bool_t TRestGeant4Event::ContainsParticleInVolume(const TString& particleName, I
 }
 
 const TRestGeant4Metadata* TRestGeant4Event::GetGeant4Metadata() const {
+    if (fGeant4Metadata != nullptr) {
+        return fGeant4Metadata;
+    }
     if (fRun == nullptr) {
         RESTError << "TRestGeant4Event::GetGeant4Metadata: fRun is nullptr" << RESTendl;
         return nullptr;
@@ -1245,16 +1675,82 @@ const TRestGeant4Metadata* TRestGeant4Event::GetGeant4Metadata() const {
     return dynamic_cast<TRestGeant4Metadata*>(fRun->GetMetadataClass("TRestGeant4Metadata"));
 }
 
+///////////////////////////////////////////////
+/// \brief Binds the metadata used to translate the volume, particle and process IDs of an event which is
+/// not read from a run. Reading an entry binds the metadata of the run instead.
+///
+void TRestGeant4Event::SetGeant4Metadata(const TRestGeant4Metadata* metadata) {
+    fGeant4Metadata = metadata;
+    for (auto& track : fTracks) {
+        track.SetGeant4Metadata(fGeant4Metadata);
+    }
+    fEnergyInVolumeIndexValid = false;
+}
+
+void TRestGeant4Event::AddPrimaryParticle(const TString& particleName, Double_t energy,
+                                          const TVector3& direction) {
+    fPrimaryParticleNames.push_back(particleName);
+    fPrimaryEnergies.push_back(energy);
+    fPrimaryDirections.push_back(direction);
+}
+
+///////////////////////////////////////////////
+/// \brief Appends a copy of the given track, and links it (and its hits) to the event and its metadata.
+///
+void TRestGeant4Event::AddTrack(const TRestGeant4Track& track) {
+    LoadHits();
+    fTracks.push_back(track);
+    // the tracks may have been moved, their hits point to them
+    LinkTracks();
+    fTracks.back().SetGeant4Metadata(fGeant4Metadata);
+
+    fHitsColumns.Clear();
+    fGenealogyValid = false;
+    fProcessOccurrencesValid = false;
+}
+
 void TRestGeant4Event::InitializeReferences(TRestRun* run) {
     TRestEvent::InitializeReferences(run);
+    fEnergyInVolumeIndexValid = false;
+    fHitsColumns.Clear();
+
+    // the metadata lookup (and its dynamic_cast) is done once per event, hits and tracks keep the pointer
+    fGeant4Metadata = nullptr;
+    if (fRun != nullptr) {
+        fGeant4Metadata = dynamic_cast<TRestGeant4Metadata*>(fRun->GetMetadataClass("TRestGeant4Metadata"));
+    }
+
+    // the lookup is not read from file, it may hold the positions of the deposits of another event
+    fEnergyDepositLookup.clear();
+    ConvertLegacyEnergyDeposits();
     /*
     This introduces overhead to event loading, but hopefully its small enough.
     If this is a problem, we could rework this approach
      */
+    fHitsReading.fPending = false;
+    if (fHitsReading.fLazyLoading) {
+        TTree* tree = fRun != nullptr ? fRun->GetEventTree() : nullptr;
+        if (tree != fHitsReading.fTree) {
+            BindHitsBranches(tree);
+        }
+        if (!fHitsReading.fBranches.empty()) {
+            fHitsReading.fEntry = fHitsReading.fTree->GetReadEntry();
+            fHitsReading.fPending = true;
+        }
+    }
+
+    LinkTracks();
     for (auto& track : fTracks) {
-        track.SetEvent(this);
-        track.fHits.SetTrack(&track);
-        track.fHits.SetEvent(this);
+        track.SetGeant4Metadata(fGeant4Metadata);
+    }
+
+    ResetTrackIDIndex();
+    UpdateTrackIDIndex();
+    fGenealogyValid = false;
+    fProcessOccurrencesValid = false;
+
+    if (fHitsReading.fColumnsOnRead) {
+        BuildHitsColumns();
     }
 }
 
@@ -1266,8 +1762,60 @@ set<string> TRestGeant4Event::GetUniqueParticles() const {
     return result;
 }
 
+namespace {
+string GetVolumeNameOrID(const TRestGeant4Metadata* metadata, Int_t volumeID) {
+    if (metadata != nullptr) {
+        const TString name = metadata->GetGeant4GeometryInfo().GetVolumeFromID(volumeID);
+        if (!name.IsNull()) {
+            return name.Data();
+        }
+    }
+    return to_string(volumeID);  // in case volume name is not found, use ID
+}
+
+string GetParticleNameOrID(const TRestGeant4Metadata* metadata, Int_t particleID) {
+    if (metadata != nullptr) {
+        const TString name = metadata->GetGeant4PhysicsInfo().GetParticleName(particleID);
+        if (!name.IsNull()) {
+            return name.Data();
+        }
+    }
+    return to_string(particleID);  // in case particle name is not found, use ID
+}
+
+string GetProcessNameOrID(const TRestGeant4Metadata* metadata, Int_t processID) {
+    if (metadata != nullptr) {
+        const TString name = metadata->GetGeant4PhysicsInfo().GetProcessName(processID);
+        if (!name.IsNull()) {
+            return name.Data();
+        }
+    }
+    return to_string(processID);  // in case process name is not found, use ID
+}
+
+/// Returns the ID of a name from the memo, translating it with findID the first time. Unknown names (-1)
+/// are not memoized, restG4 may register them later.
+template <typename FindID>
+Int_t FindMemoizedID(unordered_map<string, Int_t>& memo, const string& name, FindID findID) {
+    const auto it = memo.find(name);
+    if (it != memo.end()) {
+        return it->second;
+    }
+    const Int_t id = findID(name);
+    if (id >= 0) {
+        memo.emplace(name, id);
+    }
+    return id;
+}
+}  // namespace
+
 map<string, map<string, double>> TRestGeant4Event::GetEnergyInVolumePerProcessMap() const {
     map<string, map<string, double>> result;
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        result[GetVolumeNameOrID(metadata, fEnergyDepositVolumeID[n])]
+              [GetProcessNameOrID(metadata, fEnergyDepositProcessID[n])] += fEnergyDeposit[n];
+    }
     for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
         for (const auto& [particle, processMap] : particleProcessMap) {
             for (const auto& [process, energy] : processMap) {
@@ -1280,6 +1828,11 @@ map<string, map<string, double>> TRestGeant4Event::GetEnergyInVolumePerProcessMa
 
 map<string, map<string, double>> TRestGeant4Event::GetEnergyInVolumePerParticleMap() const {
     map<string, map<string, double>> result;
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        result[GetVolumeNameOrID(metadata, fEnergyDepositVolumeID[n])]
+              [GetParticleNameOrID(metadata, fEnergyDepositParticleID[n])] += fEnergyDeposit[n];
+    }
     for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
         for (const auto& [particle, processMap] : particleProcessMap) {
             for (const auto& [process, energy] : processMap) {
@@ -1291,7 +1844,16 @@ map<string, map<string, double>> TRestGeant4Event::GetEnergyInVolumePerParticleM
 }
 
 map<string, double> TRestGeant4Event::GetEnergyPerProcessMap() const {
+    map<Int_t, double> energyPerProcessID;
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        energyPerProcessID[fEnergyDepositProcessID[n]] += fEnergyDeposit[n];
+    }
+
     map<string, double> result;
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    for (const auto& [processID, energy] : energyPerProcessID) {
+        result[GetProcessNameOrID(metadata, processID)] += energy;
+    }
     for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
         for (const auto& [particle, processMap] : particleProcessMap) {
             for (const auto& [process, energy] : processMap) {
@@ -1303,7 +1865,16 @@ map<string, double> TRestGeant4Event::GetEnergyPerProcessMap() const {
 }
 
 map<string, double> TRestGeant4Event::GetEnergyPerParticleMap() const {
+    map<Int_t, double> energyPerParticleID;
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        energyPerParticleID[fEnergyDepositParticleID[n]] += fEnergyDeposit[n];
+    }
+
     map<string, double> result;
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    for (const auto& [particleID, energy] : energyPerParticleID) {
+        result[GetParticleNameOrID(metadata, particleID)] += energy;
+    }
     for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
         for (const auto& [particle, processMap] : particleProcessMap) {
             for (const auto& [process, energy] : processMap) {
@@ -1315,7 +1886,16 @@ map<string, double> TRestGeant4Event::GetEnergyPerParticleMap() const {
 }
 
 map<string, double> TRestGeant4Event::GetEnergyInVolumeMap() const {
+    map<Int_t, double> energyPerVolumeID;
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        energyPerVolumeID[fEnergyDepositVolumeID[n]] += fEnergyDeposit[n];
+    }
+
     map<string, double> result;
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    for (const auto& [volumeID, energy] : energyPerVolumeID) {
+        result[GetVolumeNameOrID(metadata, volumeID)] += energy;
+    }
     for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
         for (const auto& [particle, processMap] : particleProcessMap) {
             for (const auto& [process, energy] : processMap) {
@@ -1326,25 +1906,353 @@ map<string, double> TRestGeant4Event::GetEnergyInVolumeMap() const {
     return result;
 }
 
+///////////////////////////////////////////////
+/// \brief Returns the energy deposited in a volume given its name.
+///
+/// The name is translated into its volume ID through TRestGeant4GeometryInfo, and the value is read from
+/// the per-event energy index (see GetEnergyInVolume(Int_t)). When calling this method repeatedly it is
+/// cheaper to resolve the volume ID once and use the ID overload directly.
+///
+Double_t TRestGeant4Event::GetEnergyInVolume(const string& volumeName) const {
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    if (metadata == nullptr || !metadata->GetGeant4GeometryInfo().HasVolumeID(volumeName)) {
+        // volume ID cannot be resolved, only name keyed deposits can match
+        Double_t energy = 0;
+        const auto volumeIterator = fEnergyInVolumePerParticlePerProcess.find(volumeName);
+        if (volumeIterator == fEnergyInVolumePerParticlePerProcess.end()) {
+            return energy;
+        }
+        for (const auto& [particle, processMap] : volumeIterator->second) {
+            for (const auto& [process, processEnergy] : processMap) {
+                energy += processEnergy;
+            }
+        }
+        return energy;
+    }
+    return GetEnergyInVolume(metadata->GetGeant4GeometryInfo().GetIDFromVolume(volumeName));
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the energy deposited in a volume given its ID, as defined in TRestGeant4GeometryInfo.
+///
+/// The per-volume energies are computed once per event, the first time they are requested, and kept
+/// until the event is re-initialized or InvalidateEnergyInVolumeIndex is called.
+///
+Double_t TRestGeant4Event::GetEnergyInVolume(Int_t volumeID) const {
+    if (!fEnergyInVolumeIndexValid) {
+        BuildEnergyInVolumeIndex();
+    }
+    if (volumeID < 0 || volumeID >= Int_t(fEnergyInVolumeIndex.size())) {
+        return 0;
+    }
+    return fEnergyInVolumeIndex[volumeID];
+}
+
+void TRestGeant4Event::BuildEnergyInVolumeIndex() const {
+    fEnergyInVolumeIndex.clear();
+    fEnergyInVolumeIndexValid = true;
+
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        const Int_t volumeID = fEnergyDepositVolumeID[n];
+        if (volumeID < 0) {
+            continue;
+        }
+        if (volumeID >= Int_t(fEnergyInVolumeIndex.size())) {
+            fEnergyInVolumeIndex.resize(volumeID + 1, 0);
+        }
+        fEnergyInVolumeIndex[volumeID] += fEnergyDeposit[n];
+    }
+
+    if (fEnergyInVolumePerParticlePerProcess.empty()) {
+        return;
+    }
+
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    if (metadata == nullptr) {
+        return;
+    }
+    const auto& geometryInfo = metadata->GetGeant4GeometryInfo();
+
+    for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
+        if (!geometryInfo.HasVolumeID(volume)) {
+            continue;
+        }
+        const Int_t volumeID = geometryInfo.GetIDFromVolume(volume);
+        if (volumeID < 0) {
+            continue;
+        }
+        if (volumeID >= Int_t(fEnergyInVolumeIndex.size())) {
+            fEnergyInVolumeIndex.resize(volumeID + 1, 0);
+        }
+        for (const auto& [particle, processMap] : particleProcessMap) {
+            for (const auto& [process, energy] : processMap) {
+                fEnergyInVolumeIndex[volumeID] += energy;
+            }
+        }
+    }
+}
+
 map<string, map<string, map<string, double>>> TRestGeant4Event::GetEnergyInVolumePerParticlePerProcessMap()
     const {
-    return fEnergyInVolumePerParticlePerProcess;
+    map<string, map<string, map<string, double>>> result = fEnergyInVolumePerParticlePerProcess;
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        result[GetVolumeNameOrID(metadata, fEnergyDepositVolumeID[n])]
+              [GetParticleNameOrID(metadata, fEnergyDepositParticleID[n])]
+              [GetProcessNameOrID(metadata, fEnergyDepositProcessID[n])] += fEnergyDeposit[n];
+    }
+    return result;
 }
 
+///////////////////////////////////////////////
+/// \brief Adds an energy deposit given the volume, particle and process names. The names are translated
+/// into IDs using the given metadata (restG4 passes its own, since the event has no run there), or the
+/// metadata of the run of the event if none is given.
+///
+/// An event keeps its deposits either in the ID arrays or keyed by name, never in both. If a name cannot
+/// be translated (or there is no metadata) all the deposits of the event are kept keyed by name: restG4
+/// must pass its metadata (or bind it with SetGeant4Metadata) for the events to be written with IDs.
+///
+/// The translated names are memoized, so each deposit costs one lookup per name.
+///
 void TRestGeant4Event::AddEnergyInVolumeForParticleForProcess(Double_t energy, const string& volumeName,
                                                               const string& particleName,
-                                                              const string& processName) {
+                                                              const string& processName,
+                                                              const TRestGeant4Metadata* metadata) {
     if (energy <= 0) {
         return;
     }
+
+    if (metadata == nullptr) {
+        metadata = FindGeant4Metadata();
+    }
+    if (metadata != nullptr && fEnergyInVolumePerParticlePerProcess.empty()) {
+        if (metadata != fEnergyDepositNamesMetadata) {
+            fEnergyDepositNamesMetadata = metadata;
+            fEnergyDepositVolumeIDs.clear();
+            fEnergyDepositParticleIDs.clear();
+            fEnergyDepositProcessIDs.clear();
+        }
+        const auto& geometryInfo = metadata->GetGeant4GeometryInfo();
+        const auto& physicsInfo = metadata->GetGeant4PhysicsInfo();
+        const Int_t volumeID = FindMemoizedID(
+            fEnergyDepositVolumeIDs, volumeName,
+            [&](const string& name) { return geometryInfo.FindIDFromVolume(name); });
+        const Int_t particleID = FindMemoizedID(
+            fEnergyDepositParticleIDs, particleName,
+            [&](const string& name) { return physicsInfo.FindParticleID(name); });
+        const Int_t processID = FindMemoizedID(
+            fEnergyDepositProcessIDs, processName,
+            [&](const string& name) { return physicsInfo.FindProcessID(name); });
+        if (volumeID >= 0 && particleID >= 0 && processID >= 0) {
+            AddEnergyInVolumeForParticleForProcess(energy, volumeID, particleID, processID);
+            return;
+        }
+    }
+
+    // the deposits already stored by ID are moved to the name keyed map
+    for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+        fEnergyInVolumePerParticlePerProcess[GetVolumeNameOrID(metadata, fEnergyDepositVolumeID[n])]
+                                            [GetParticleNameOrID(metadata, fEnergyDepositParticleID[n])]
+                                            [GetProcessNameOrID(metadata, fEnergyDepositProcessID[n])] +=
+            fEnergyDeposit[n];
+    }
+    ClearEnergyDepositArrays();
+
     fEnergyInVolumePerParticlePerProcess[volumeName][particleName][processName] += energy;
     fTotalDepositedEnergy += energy;
+    fEnergyInVolumeIndexValid = false;
+}
+
+///////////////////////////////////////////////
+/// \brief Adds an energy deposit given the volume ID (TRestGeant4GeometryInfo) and the particle and
+/// process IDs (TRestGeant4PhysicsInfo). The deposit is also added to the total deposited energy.
+///
+void TRestGeant4Event::AddEnergyInVolumeForParticleForProcess(Double_t energy, Int_t volumeID,
+                                                              Int_t particleID, Int_t processID) {
+    if (energy <= 0) {
+        return;
+    }
+    if (!fEnergyInVolumePerParticlePerProcess.empty()) {
+        // the deposits of this event are keyed by name, see the overload above
+        const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+        fEnergyInVolumePerParticlePerProcess[GetVolumeNameOrID(metadata, volumeID)]
+                                            [GetParticleNameOrID(metadata, particleID)]
+                                            [GetProcessNameOrID(metadata, processID)] += energy;
+        fEnergyInVolumeIndexValid = false;
+    } else {
+        AddEnergyDeposit(energy, volumeID, particleID, processID);
+    }
+    fTotalDepositedEnergy += energy;
+}
+
+void TRestGeant4Event::AddEnergyDeposit(Double_t energy, Int_t volumeID, Int_t particleID, Int_t processID) {
+    if (fEnergyDepositLookup.size() != GetNumberOfEnergyDeposits()) {
+        // deposits were read from file or copied, the lookup table needs to be rebuilt
+        fEnergyDepositLookup.clear();
+        fEnergyDepositLookup.reserve(GetNumberOfEnergyDeposits());
+        for (size_t n = 0; n < GetNumberOfEnergyDeposits(); n++) {
+            fEnergyDepositLookup[{fEnergyDepositVolumeID[n], fEnergyDepositParticleID[n],
+                                  fEnergyDepositProcessID[n]}] = n;
+        }
+    }
+
+    const EnergyDepositKey key = {volumeID, particleID, processID};
+    const auto lookup = fEnergyDepositLookup.find(key);
+    if (lookup != fEnergyDepositLookup.end()) {
+        fEnergyDeposit[lookup->second] += energy;
+    } else {
+        fEnergyDepositLookup[key] = GetNumberOfEnergyDeposits();
+        fEnergyDepositVolumeID.push_back(volumeID);
+        fEnergyDepositParticleID.push_back(particleID);
+        fEnergyDepositProcessID.push_back(processID);
+        fEnergyDeposit.push_back(energy);
+    }
+    fEnergyInVolumeIndexValid = false;
+}
+
+void TRestGeant4Event::ClearEnergyDepositArrays() {
+    fEnergyDepositVolumeID.clear();
+    fEnergyDepositParticleID.clear();
+    fEnergyDepositProcessID.clear();
+    fEnergyDeposit.clear();
+    fEnergyDepositLookup.clear();
+    fEnergyInVolumeIndexValid = false;
+}
+
+void TRestGeant4Event::ClearEnergyDeposits() {
+    ClearEnergyDepositArrays();
+    fEnergyInVolumePerParticlePerProcess.clear();
+}
+
+///////////////////////////////////////////////
+/// \brief Translates the name keyed deposits (files written before version 10) into the ID arrays.
+///
+/// Those files have no ID arrays, so reading an entry leaves the arrays of the previous entry in memory:
+/// they are always cleared when name keyed deposits are present. If any of the names is not found in the
+/// metadata, all the deposits are kept keyed by name.
+///
+void TRestGeant4Event::ConvertLegacyEnergyDeposits() {
+    if (fEnergyInVolumePerParticlePerProcess.empty()) {
+        return;
+    }
+    ClearEnergyDepositArrays();
+
+    const TRestGeant4Metadata* metadata = FindGeant4Metadata();
+    if (metadata == nullptr) {
+        return;
+    }
+    const auto& geometryInfo = metadata->GetGeant4GeometryInfo();
+    const auto& physicsInfo = metadata->GetGeant4PhysicsInfo();
+
+    // the names are translated first, nothing is converted unless all of them are known
+    vector<tuple<Int_t, Int_t, Int_t, double>> deposits;
+    for (const auto& [volume, particleProcessMap] : fEnergyInVolumePerParticlePerProcess) {
+        const Int_t volumeID = geometryInfo.FindIDFromVolume(volume);
+        if (volumeID < 0) {
+            return;
+        }
+        for (const auto& [particle, processMap] : particleProcessMap) {
+            const Int_t particleID = physicsInfo.FindParticleID(particle);
+            if (particleID < 0) {
+                return;
+            }
+            for (const auto& [process, energy] : processMap) {
+                const Int_t processID = physicsInfo.FindProcessID(process);
+                if (processID < 0) {
+                    return;
+                }
+                deposits.emplace_back(volumeID, particleID, processID, energy);
+            }
+        }
+    }
+
+    for (const auto& [volumeID, particleID, processID, energy] : deposits) {
+        AddEnergyDeposit(energy, volumeID, particleID, processID);
+    }
+    fEnergyInVolumePerParticlePerProcess.clear();
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the hits of the event produced by a process, given its ID in TRestGeant4PhysicsInfo, as
+/// (track index, hit index) pairs sorted by track and hit.
+///
+/// The index of all the processes is built in a single pass over the hits the first time it is
+/// requested, and kept until the event is re-initialized or InvalidateProcessOccurrences is called. Rare
+/// processes (captures, decays, ...) can then be visited without scanning all the hits of the event.
+///
+TRestGeant4ProcessOccurrences TRestGeant4Event::GetProcessOccurrences(Int_t processID) const {
+    if (!fProcessOccurrencesValid) {
+        BuildProcessOccurrences();
+    }
+    if (processID < 0 || processID + 1 >= Int_t(fProcessOccurrenceOffsets.size())) {
+        return {};
+    }
+    const auto* occurrences = fProcessOccurrences.data();
+    return {occurrences + fProcessOccurrenceOffsets[processID],
+            occurrences + fProcessOccurrenceOffsets[processID + 1]};
+}
+
+void TRestGeant4Event::BuildProcessOccurrences() const {
+    fProcessOccurrenceOffsets.clear();
+    fProcessOccurrences.clear();
+    fProcessOccurrencesValid = true;
+
+    // count the hits of each process, then place them (counting sort, keeps the track and hit order)
+    for (const auto& track : fTracks) {
+        const auto& hits = track.GetHits();
+        for (size_t n = 0; n < hits.GetNumberOfHits(); n++) {
+            const Int_t processID = hits.GetProcessId(n);
+            if (processID < 0) {
+                continue;
+            }
+            if (processID + 2 > Int_t(fProcessOccurrenceOffsets.size())) {
+                fProcessOccurrenceOffsets.resize(processID + 2, 0);
+            }
+            fProcessOccurrenceOffsets[processID + 1]++;
+        }
+    }
+    for (size_t id = 1; id < fProcessOccurrenceOffsets.size(); id++) {
+        fProcessOccurrenceOffsets[id] += fProcessOccurrenceOffsets[id - 1];
+    }
+    if (fProcessOccurrenceOffsets.empty()) {
+        return;
+    }
+
+    fProcessOccurrences.resize(fProcessOccurrenceOffsets.back());
+    std::vector<size_t> position(fProcessOccurrenceOffsets.begin(), fProcessOccurrenceOffsets.end() - 1);
+    for (size_t trackIndex = 0; trackIndex < fTracks.size(); trackIndex++) {
+        const auto& hits = fTracks[trackIndex].GetHits();
+        for (size_t n = 0; n < hits.GetNumberOfHits(); n++) {
+            const Int_t processID = hits.GetProcessId(n);
+            if (processID < 0) {
+                continue;
+            }
+            fProcessOccurrences[position[processID]++] = {Int_t(trackIndex), Int_t(n)};
+        }
+    }
 }
 
 std::pair<double, double> TRestGeant4Event::GetTimeRangeOfIonizationInVolume(const string& volumeName) const {
     std::pair<double, double> result = {std::numeric_limits<double>::max(),
                                         std::numeric_limits<double>::min()};
 
+    if (HasHitsColumns()) {
+        const TRestGeant4Metadata* metadata = GetGeant4Metadata();
+        if (metadata == nullptr) {
+            return result;
+        }
+        const Int_t volumeID = metadata->GetGeant4GeometryInfo().GetIDFromVolume(volumeName);
+        for (size_t n = 0; n < fHitsColumns.GetNumberOfHits(); n++) {
+            if (fHitsColumns.fVolumeID[n] == volumeID && fHitsColumns.fEnergy[n] > 0) {
+                const double time = fHitsColumns.fTime[n];
+                result.first = std::min(result.first, time);
+                result.second = std::max(result.second, time);
+            }
+        }
+        return result;
+    }
+
     for (const auto& track : fTracks) {
         const auto& hits = track.GetHits();
         for (int i = 0; i < int(hits.GetNumberOfHits()); i++) {
@@ -1358,3 +2266,153 @@ std::pair<double, double> TRestGeant4Event::GetTimeRangeOfIonizationInVolume(con
 
     return result;
 }
+
+void TRestGeant4HitsColumns::Clear() {
+    fX.clear();
+    fY.clear();
+    fZ.clear();
+    fTime.clear();
+    fEnergy.clear();
+    fKineticEnergy.clear();
+    fProcessID.clear();
+    fVolumeID.clear();
+    fMomentumDirectionX.clear();
+    fMomentumDirectionY.clear();
+    fMomentumDirectionZ.clear();
+    fTrackOffsets.clear();
+}
+
+void TRestGeant4HitsColumns::Reserve(size_t numberOfHits, size_t numberOfTracks) {
+    fX.reserve(numberOfHits);
+    fY.reserve(numberOfHits);
+    fZ.reserve(numberOfHits);
+    fTime.reserve(numberOfHits);
+    fEnergy.reserve(numberOfHits);
+    fKineticEnergy.reserve(numberOfHits);
+    fProcessID.reserve(numberOfHits);
+    fVolumeID.reserve(numberOfHits);
+    fMomentumDirectionX.reserve(numberOfHits);
+    fMomentumDirectionY.reserve(numberOfHits);
+    fMomentumDirectionZ.reserve(numberOfHits);
+    fTrackOffsets.reserve(numberOfTracks + 1);
+}
+
+///////////////////////////////////////////////
+/// \brief Builds a flat (structure-of-arrays) copy of the hits of all the tracks in the event.
+///
+/// Once built, event-wide queries such as GetHits, GetNumberOfHits, SetBoundaries or
+/// GetTimeRangeOfIonizationInVolume read from these contiguous arrays instead of visiting the hits
+/// container of every track. The per-track hits are left untouched, they are still the ones stored on disk.
+/// The columns are a snapshot: they are dropped when a new entry is read, and by every method giving write
+/// access to the tracks or hits (GetTrackPointer, AddTrack, ClearTracks, TRestGeant4Track::GetHitsPointer,
+/// TRestGeant4Hits::GetEnergyRef...), and must be rebuilt afterwards if needed. Readers can have them
+/// built for each entry with SetHitsColumnsOnRead.
+///
+void TRestGeant4Event::BuildHitsColumns() {
+    fHitsColumns.Clear();
+
+    size_t numberOfHits = 0;
+    for (const auto& track : fTracks) {
+        numberOfHits += track.GetHits().GetNumberOfHits();
+    }
+    fHitsColumns.Reserve(numberOfHits, fTracks.size());
+
+    fHitsColumns.fTrackOffsets.push_back(0);
+    for (const auto& track : fTracks) {
+        const auto& hits = track.GetHits();
+        for (size_t n = 0; n < hits.GetNumberOfHits(); n++) {
+            fHitsColumns.fX.push_back(hits.GetX(n));
+            fHitsColumns.fY.push_back(hits.GetY(n));
+            fHitsColumns.fZ.push_back(hits.GetZ(n));
+            fHitsColumns.fTime.push_back(hits.GetTime(n));
+            fHitsColumns.fEnergy.push_back(hits.GetEnergy(n));
+            fHitsColumns.fKineticEnergy.push_back(hits.GetKineticEnergy(n));
+            fHitsColumns.fProcessID.push_back(hits.GetProcessId(n));
+            fHitsColumns.fVolumeID.push_back(hits.GetVolumeId(n));
+            const TVector3& direction = hits.GetMomentumDirection(n);
+            fHitsColumns.fMomentumDirectionX.push_back(direction.X());
+            fHitsColumns.fMomentumDirectionY.push_back(direction.Y());
+            fHitsColumns.fMomentumDirectionZ.push_back(direction.Z());
+        }
+        fHitsColumns.fTrackOffsets.push_back(fHitsColumns.GetNumberOfHits());
+    }
+}
+
+size_t TRestGeant4HitsView::GetNumberOfHits() const {
+    size_t numberOfHits = 0;
+    for (auto it = begin(); it != end(); ++it) {
+        numberOfHits++;
+    }
+    return numberOfHits;
+}
+
+Double_t TRestGeant4HitsView::GetTotalEnergy() const {
+    Double_t energy = 0;
+    for (const auto& hit : *this) {
+        energy += hit.GetEnergy();
+    }
+    return energy;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the energy of the hits of the view found inside the sphere with the given center and
+/// radius. Equivalent to TRestHits::GetEnergyInSphere on the hits returned by TRestGeant4Event::GetHits.
+///
+Double_t TRestGeant4HitsView::GetEnergyInSphere(Double_t x, Double_t y, Double_t z, Double_t radius) const {
+    const Double_t radius2 = radius * radius;
+    Double_t energy = 0;
+    for (const auto& hit : *this) {
+        const Double_t dx = hit.GetX() - x;
+        const Double_t dy = hit.GetY() - y;
+        const Double_t dz = hit.GetZ() - z;
+        if (dx * dx + dy * dy + dz * dz < radius2) {
+            energy += hit.GetEnergy();
+        }
+    }
+    return energy;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the energy of the hits of the view found inside each of the spheres with the given
+/// center and radii, in the order of the radii. It is equivalent to calling GetEnergyInSphere for each
+/// radius, but it takes a single pass over the hits: each hit is assigned to the smallest sphere that
+/// contains it, and the energies are then accumulated from the smallest to the largest sphere.
+///
+std::vector<Double_t> TRestGeant4HitsView::GetEnergyInSpheres(Double_t x, Double_t y, Double_t z,
+                                                             const std::vector<Double_t>& radii) const {
+    std::vector<size_t> order(radii.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&radii](size_t a, size_t b) { return radii[a] < radii[b]; });
+
+    std::vector<Double_t> sortedRadii2(radii.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        sortedRadii2[i] = radii[order[i]] * radii[order[i]];
+    }
+
+    // energy of the hits whose smallest containing sphere is the i-th one
+    std::vector<Double_t> shellEnergy(radii.size(), 0);
+    for (const auto& hit : *this) {
+        const Double_t energy = hit.GetEnergy();
+        if (energy == 0) {
+            continue;
+        }
+        const Double_t dx = hit.GetX() - x;
+        const Double_t dy = hit.GetY() - y;
+        const Double_t dz = hit.GetZ() - z;
+        const Double_t distance2 = dx * dx + dy * dy + dz * dz;
+        // first sphere with distance2 < radius2
+        const size_t i = std::upper_bound(sortedRadii2.begin(), sortedRadii2.end(), distance2) -
+                         sortedRadii2.begin();
+        if (i < shellEnergy.size()) {
+            shellEnergy[i] += energy;
+        }
+    }
+
+    std::vector<Double_t> energies(radii.size(), 0);
+    Double_t energy = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        energy += shellEnergy[i];
+        energies[order[i]] = energy;
+    }
+    return energies;
+}
@@ -4,49 +4,90 @@
 
 #include "TRestGeant4GeometryInfo.h"
 
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TMD5.h>
 #include <TPRegexp.h>
 #include <TXMLEngine.h>
+#include <unistd.h>
 
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
 
 #include "TRestStringHelper.h"
 
 using namespace std;
 
+namespace {
+/// Guards the build of the transient indices of all the geometry infos
+std::mutex indicesMutex;
+/// Guards the memos of translated paths, which are modified by every lookup
+std::mutex translatedPathsMutex;
+}  // namespace
+
 namespace myXml {
-XMLNodePointer_t FindChildByName(TXMLEngine xml, XMLNodePointer_t node, const TString& name) {
+XMLNodePointer_t FindChildByName(TXMLEngine& xml, XMLNodePointer_t node, const char* name) {
     XMLNodePointer_t child = xml.GetChild(node);
     while (child) {
-        TString childName = xml.GetNodeName(child);
-        if (childName.EqualTo(name)) {
+        if (strcmp(xml.GetNodeName(child), name) == 0) {
             return child;
         }
         child = xml.GetNext(child);
     }
     return nullptr;
 }
-TString GetNodeAttribute(TXMLEngine xml, XMLNodePointer_t node, const TString& attributeName) {
+TString GetNodeAttribute(TXMLEngine& xml, XMLNodePointer_t node, const char* attributeName) {
     XMLAttrPointer_t attr = xml.GetFirstAttr(node);
     while (attr) {
-        if (TString(xml.GetAttrName(attr)).EqualTo(attributeName)) {
-            TString refName = xml.GetAttrValue(attr);
-            return refName;
+        if (strcmp(xml.GetAttrName(attr), attributeName) == 0) {
+            return xml.GetAttrValue(attr);
         }
         attr = xml.GetNextAttr(attr);
     }
     return {};
 }
-XMLNodePointer_t GetChildByAttributeValue(TXMLEngine xml, XMLNodePointer_t node, const TString& attributeName,
-                                          const TString& attributeValue) {
-    XMLNodePointer_t child = xml.GetChild(node);
-    while (child) {
-        TString childAttributeValue = GetNodeAttribute(xml, child, attributeName);
-        if (childAttributeValue.EqualTo(attributeValue)) {
-            return child;
+/// A child of the GDML <structure> (logical volume or assembly) with its physical volumes
+struct StructureElement {
+    TString name;
+    bool isAssembly = false;
+    /// Physical volume name and referenced volume (logical volume or assembly) name, in file order
+    vector<pair<TString, TString>> placements;
+};
+/// Reads all the children of the GDML <structure> in a single pass, in file order
+vector<StructureElement> ReadStructure(TXMLEngine& xml, XMLNodePointer_t structure) {
+    vector<StructureElement> elements;
+    XMLNodePointer_t child = xml.GetChild(structure);
+    while (child) {  // loop over the direct children of structure (logical volumes and assemblies)
+        StructureElement element;
+        element.name = GetNodeAttribute(xml, child, "name");
+        element.isAssembly = strcmp(xml.GetNodeName(child), "assembly") == 0;
+        // children of a volume or assembly are physical volumes
+        XMLNodePointer_t physicalVolumeNode = xml.GetChild(child);
+        while (physicalVolumeNode) {
+            const TString physicalVolumeName = GetNodeAttribute(xml, physicalVolumeNode, "name");
+            // this are volumeref, position and rotation
+            XMLNodePointer_t volumeRefNode = xml.GetChild(physicalVolumeNode);
+            while (volumeRefNode) {
+                if (strcmp(xml.GetNodeName(volumeRefNode), "volumeref") == 0) {
+                    // the logical volume name
+                    element.placements.emplace_back(physicalVolumeName,
+                                                    GetNodeAttribute(xml, volumeRefNode, "ref"));
+                }
+                volumeRefNode = xml.GetNext(volumeRefNode);
+            }
+            physicalVolumeNode = xml.GetNext(physicalVolumeNode);
         }
+        elements.push_back(std::move(element));
         child = xml.GetNext(child);
     }
-    return nullptr;
+    return elements;
 }
 void AddVolumesRecursively(vector<TString>* physicalNames, vector<TString>* logicalNames,
                            const vector<TString>& children, map<TString, TString>& nameTable,
@@ -67,11 +108,121 @@ void AddVolumesRecursively(vector<TString>* physicalNames, vector<TString>* logi
 }
 }  // namespace myXml
 
+namespace {
+/// Version of the contents of the geometry cache files, to be increased whenever the tables computed by
+/// PopulateFromGdml change
+constexpr const char* kGdmlCacheVersion = "1";
+
+///////////////////////////////////////////////
+/// \brief Returns the name of the geometry cache file of a GDML file, or an empty string if the cache
+/// is disabled or the GDML file cannot be read.
+///
+/// The cache is disabled by default, it is enabled by setting REST_GEANT4_GEOMETRY_CACHE to the directory
+/// where the cache files are stored. They are named after the MD5 hash of the GDML contents, the path
+/// separator and the cache version, so any change in the geometry gives a different cache file.
+///
+TString GdmlCacheFilename(const TString& gdmlFilename, const TString& pathSeparator) {
+    const char* cacheDirectory = getenv("REST_GEANT4_GEOMETRY_CACHE");
+    if (cacheDirectory == nullptr || strlen(cacheDirectory) == 0) {
+        return "";
+    }
+
+    ifstream gdmlFile(gdmlFilename.Data(), ios::binary);
+    if (!gdmlFile) {
+        return "";
+    }
+    stringstream contents;
+    contents << gdmlFile.rdbuf() << '\0' << pathSeparator << '\0' << kGdmlCacheVersion;
+    const string key = contents.str();
+
+    TMD5 md5;
+    md5.Update((const UChar_t*)key.data(), key.size());
+    md5.Final();
+
+    return TString(string(cacheDirectory) + "/geometryInfo_" + md5.AsString() + ".root");
+}
+}  // namespace
+
+///////////////////////////////////////////////
+/// \brief Fills the GDML tables (the physical and logical volume names and the assembly maps) from a
+/// cache file written by SaveToGdmlCache. Returns false if the cache file cannot be used.
+///
+bool TRestGeant4GeometryInfo::LoadFromGdmlCache(const TString& cacheFilename) {
+    if (!filesystem::exists(cacheFilename.Data())) {
+        return false;
+    }
+    // opening the file changes the current ROOT directory, which is restored on return
+    TDirectory::TContext context;
+    unique_ptr<TFile> file(TFile::Open(cacheFilename, "READ"));
+    if (file == nullptr || file->IsZombie()) {
+        return false;
+    }
+    unique_ptr<TRestGeant4GeometryInfo> cache(file->Get<TRestGeant4GeometryInfo>("geometryInfo"));
+    if (cache == nullptr || cache->fPathSeparator != fPathSeparator || cache->fGdmlNewPhysicalNames.empty()) {
+        return false;
+    }
+
+    fGdmlNewPhysicalNames = cache->fGdmlNewPhysicalNames;
+    fGdmlLogicalNames = cache->fGdmlLogicalNames;
+    fGeant4AssemblyImprintToGdmlNameMap = cache->fGeant4AssemblyImprintToGdmlNameMap;
+    fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap =
+        cache->fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap;
+    fGeant4AssemblyImprintToAssemblyLogicalNameMap = cache->fGeant4AssemblyImprintToAssemblyLogicalNameMap;
+    return true;
+}
+
+///////////////////////////////////////////////
+/// \brief Writes the GDML tables to a cache file, see LoadFromGdmlCache. The file is written under a
+/// temporary name and then renamed, so that concurrent jobs never read a partial cache file. The cache is
+/// silently skipped if its directory cannot be created or is not writable.
+///
+void TRestGeant4GeometryInfo::SaveToGdmlCache(const TString& cacheFilename) const {
+    TRestGeant4GeometryInfo cache;
+    cache.fPathSeparator = fPathSeparator;
+    cache.fGdmlNewPhysicalNames = fGdmlNewPhysicalNames;
+    cache.fGdmlLogicalNames = fGdmlLogicalNames;
+    cache.fGeant4AssemblyImprintToGdmlNameMap = fGeant4AssemblyImprintToGdmlNameMap;
+    cache.fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap =
+        fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap;
+    cache.fGeant4AssemblyImprintToAssemblyLogicalNameMap = fGeant4AssemblyImprintToAssemblyLogicalNameMap;
+
+    const auto cacheDirectory = filesystem::path(cacheFilename.Data()).parent_path();
+    error_code error;
+    filesystem::create_directories(cacheDirectory, error);
+    if (error || access(cacheDirectory.c_str(), W_OK) != 0) {
+        return;
+    }
+    TDirectory::TContext context;
+    const string temporaryFilename = string(cacheFilename.Data()) + "." + to_string(getpid()) + ".tmp";
+    {
+        unique_ptr<TFile> file(TFile::Open(temporaryFilename.c_str(), "RECREATE"));
+        if (file == nullptr || file->IsZombie()) {
+            return;
+        }
+        file->WriteObject(&cache, "geometryInfo");
+        file->Close();
+    }
+    filesystem::rename(temporaryFilename, cacheFilename.Data(), error);
+    if (error) {
+        filesystem::remove(temporaryFilename, error);
+    }
+}
+
 void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
     /*
      * Fills 'fGdmlNewPhysicalNames' with physical volume names generated from GDML
      */
     cout << "TRestGeant4GeometryInfo::PopulateFromGdml - " << gdmlFilename << endl;
+
+    InvalidateIndices();
+
+    // the tables only depend on the GDML contents, they are reused if this GDML was already processed
+    const TString cacheFilename = GdmlCacheFilename(gdmlFilename, fPathSeparator);
+    if (!cacheFilename.IsNull() && LoadFromGdmlCache(cacheFilename)) {
+        cout << "TRestGeant4GeometryInfo::PopulateFromGdml - Using geometry cache " << cacheFilename << endl;
+        return;
+    }
+
     // Geometry must be in GDML
     TXMLEngine xml;
     XMLDocPointer_t xmldoc = xml.ParseFile(gdmlFilename.Data());
@@ -82,7 +233,20 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
     }
     XMLNodePointer_t mainNode = xml.DocGetRootElement(xmldoc);
     XMLNodePointer_t structure = myXml::FindChildByName(xml, mainNode, "structure");
-    XMLNodePointer_t child = xml.GetChild(structure);
+
+    // The structure is read once and indexed by name, all the tables are built from the index
+    const vector<myXml::StructureElement> elements = myXml::ReadStructure(xml, structure);
+    xml.FreeDoc(xmldoc);
+
+    unordered_map<string, size_t> elementIndex;  // first element with each name
+    for (size_t i = 0; i < elements.size(); i++) {
+        elementIndex.emplace(elements[i].name.Data(), i);
+    }
+    const auto findElement = [&elements,
+                              &elementIndex](const TString& name) -> const myXml::StructureElement* {
+        const auto it = elementIndex.find(name.Data());
+        return it != elementIndex.end() ? &elements[it->second] : nullptr;
+    };
 
     /* When a PV is placed from an assembly, its daughter physical volumes are imprinted into the mother
     volume where you are placing the assembly. This daughter PV are named following the format:
@@ -93,13 +257,11 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
     map<TString, TString> gdmlToGeant4AssemblyNameMap;         // e.g. "assemblyName" -> "av_1"
     map<TString, size_t> gdmlAssemblyNameToImprintCounterMap;  // to track the number of imprints per assembly
     RESTDebug << "Searching for assemblies..." << RESTendl;
-    while (child) {  // loop over the direct children of structure (logical volumes and assemblies)
-        TString name = xml.GetNodeName(child);  // name of the type of children: "volume" or "assembly"
-        if (!name.EqualTo("assembly")) {
-            child = xml.GetNext(child);
+    for (const auto& element : elements) {
+        if (!element.isAssembly) {
             continue;
         }
-        TString assemblyName = myXml::GetNodeAttribute(xml, child, "name");
+        const TString& assemblyName = element.name;
         gdmlToGeant4AssemblyNameMap[assemblyName] =
             "av_" + to_string(++assemblyCounter);               // first assembly is av_1
         gdmlAssemblyNameToImprintCounterMap[assemblyName] = 0;  // initialize with the assembly found
@@ -113,43 +275,46 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
         bool hasNestedAssemblies = false;
         std::map<TString, TString> childrenGeant4toGdmlMap;
         size_t childrenPVCounter = 0;
-        auto physicalVolumeNode =
-            xml.GetChild(child);  // children of a volume or assembly are physical volumes
-        while (physicalVolumeNode) {
-            auto physicalVolumeName = myXml::GetNodeAttribute(xml, physicalVolumeNode, "name");
-            auto volumeRefNode =
-                xml.GetChild(physicalVolumeNode);  // this are volumeref, position and rotation
-            while (volumeRefNode) {
-                TString volumeRefNodeName =
-                    xml.GetNodeName(volumeRefNode);  // "volumeref", "position" or "rotation"
-                if (volumeRefNodeName.EqualTo("volumeref")) {
-                    TString refName =
-                        myXml::GetNodeAttribute(xml, volumeRefNode, "ref");  // the logical volume name
-                    TString geant4Name =
-                        refName + "_pv_" +
-                        to_string(childrenPVCounter++);  // first pv is logicalVolumeName_pv_0
-                    childrenGeant4toGdmlMap[geant4Name] = physicalVolumeName;
-                    if (gdmlToGeant4AssemblyNameMap.count(refName) > 0) {
-                        hasNestedAssemblies = true;
-                    } else {
-                        if (hasNestedAssemblies) {
-                            RESTError << "TRestGeant4GeometryInfo::PopulateFromGdml - Assembly '"
-                                      << assemblyName << "' contains physical volumes from normal "
-                                      << "(i.e. non-assembly) logical volumes defined after physical volumes "
-                                      << "from assemblies. Due to a Geant4 bug you cannot do this. "
-                                      << "Please define the physical volumes from the assemblies last."
-                                      << RESTendl;
-                        }
-                    }
+        for (const auto& [physicalVolumeName, refName] : element.placements) {
+            TString geant4Name =
+                refName + "_pv_" + to_string(childrenPVCounter++);  // first pv is logicalVolumeName_pv_0
+            childrenGeant4toGdmlMap[geant4Name] = physicalVolumeName;
+            if (gdmlToGeant4AssemblyNameMap.count(refName) > 0) {
+                hasNestedAssemblies = true;
+            } else {
+                if (hasNestedAssemblies) {
+                    RESTError << "TRestGeant4GeometryInfo::PopulateFromGdml - Assembly '" << assemblyName
+                              << "' contains physical volumes from normal "
+                              << "(i.e. non-assembly) logical volumes defined after physical volumes "
+                              << "from assemblies. Due to a Geant4 bug you cannot do this. "
+                              << "Please define the physical volumes from the assemblies last." << RESTendl;
                 }
-                volumeRefNode = xml.GetNext(volumeRefNode);
             }
-            physicalVolumeNode = xml.GetNext(physicalVolumeNode);
         }
         fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap[assemblyName] = childrenGeant4toGdmlMap;
-        child = xml.GetNext(child);
     }
 
+    // Whether a volume places an assembly at any depth. Volumes that do not are skipped by the imprint
+    // search below, since it only assigns names to assemblies.
+    vector<signed char> containsAssemblies(elements.size(), -1);
+    std::function<bool(const TString&)> ContainsAssemblies = [&](const TString& volumeName) {
+        const auto it = elementIndex.find(volumeName.Data());
+        if (it == elementIndex.end()) {
+            return false;
+        }
+        if (containsAssemblies[it->second] == -1) {
+            containsAssemblies[it->second] = 0;  // guards against cycles
+            for (const auto& placement : elements[it->second].placements) {
+                if (gdmlToGeant4AssemblyNameMap.count(placement.second) > 0 ||
+                    ContainsAssemblies(placement.second)) {
+                    containsAssemblies[it->second] = 1;
+                    break;
+                }
+            }
+        }
+        return containsAssemblies[it->second] == 1;
+    };
+
     /*Recursive function to obtain the prefix 'av_WWW_impr_XXX' of the daughters of the assemblies imprints.
     When a PV is placed from an assembly, its daughter physical volumes are imprinted into the mother
     volume where you are placing the assembly. This daughter PV are named following the format:
@@ -159,99 +324,63 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
     highest assembly which begins this chain and its "av_WWW" is used for all its consecutive assembly
     children imprints and each of this assembly children adds +1 to the imprint number of the
     godFatherAssembly.*/
-    std::function<void(const XMLNodePointer_t, const TString, TString)> ProcessNestedAssembliesRecursively =
-        [&](const XMLNodePointer_t parentNode, const TString godFatherAssemblyName, const TString pathSoFar) {
-            auto physicalVolumeNode = xml.GetChild(parentNode);
-            // godFatherAssemblyName = parentNode logical name // the highest assembly volume in the nested
-            // chain
-            while (physicalVolumeNode) {
-                auto physicalVolumeName = myXml::GetNodeAttribute(xml, physicalVolumeNode, "name");
-                auto volumeRefNode =
-                    xml.GetChild(physicalVolumeNode);  // this are volumeref, position and rotation
-                while (volumeRefNode) {
-                    TString volumeRefNodeName =
-                        xml.GetNodeName(volumeRefNode);  // "volumeref", "position" or "rotation"
-                    if (volumeRefNodeName.EqualTo("volumeref")) {
-                        TString refName =
-                            myXml::GetNodeAttribute(xml, volumeRefNode, "ref");  // the logical volume name
-                        if (gdmlToGeant4AssemblyNameMap.count(refName) > 0) {
-                            // it's an assembly
-                            TString newGodFatherAssemblyName = godFatherAssemblyName;
-                            if (newGodFatherAssemblyName.IsNull()) {
-                                // start assembly children chain with this assembly as godFather
-                                newGodFatherAssemblyName = refName;
-                            }
-                            size_t imprintCounter =
-                                ++gdmlAssemblyNameToImprintCounterMap[newGodFatherAssemblyName];
-                            TString imprint = gdmlToGeant4AssemblyNameMap[newGodFatherAssemblyName] +
-                                              "_impr_" + to_string(imprintCounter);
-                            TString path =
-                                pathSoFar + (pathSoFar.IsNull() ? "" : fPathSeparator) + physicalVolumeName;
-                            fGeant4AssemblyImprintToGdmlNameMap[imprint] = path;
-                            // Continue the assembly children chain with its correspondant godFatherAssembly
-                            // and path
-                            auto assemblyNode =
-                                myXml::GetChildByAttributeValue(xml, structure, "name", refName);
-                            ProcessNestedAssembliesRecursively(assemblyNode, newGodFatherAssemblyName, path);
-                        } else {
-                            // its a regular logical volume
-                            // Regular children resets the godFatherAssembly and path
-                            auto assemblyNode =
-                                myXml::GetChildByAttributeValue(xml, structure, "name", refName);
-                            ProcessNestedAssembliesRecursively(assemblyNode, "", "");
-                        }
+    std::function<void(const myXml::StructureElement*, const TString, TString)>
+        ProcessNestedAssembliesRecursively = [&](const myXml::StructureElement* parent,
+                                                 const TString godFatherAssemblyName,
+                                                 const TString pathSoFar) {
+            if (parent == nullptr) {
+                return;
+            }
+            for (const auto& [physicalVolumeName, refName] : parent->placements) {
+                if (gdmlToGeant4AssemblyNameMap.count(refName) > 0) {
+                    // it's an assembly
+                    TString newGodFatherAssemblyName = godFatherAssemblyName;
+                    if (newGodFatherAssemblyName.IsNull()) {
+                        // start assembly children chain with this assembly as godFather
+                        newGodFatherAssemblyName = refName;
                     }
-                    volumeRefNode = xml.GetNext(volumeRefNode);
+                    size_t imprintCounter = ++gdmlAssemblyNameToImprintCounterMap[newGodFatherAssemblyName];
+                    TString imprint = gdmlToGeant4AssemblyNameMap[newGodFatherAssemblyName] + "_impr_" +
+                                      to_string(imprintCounter);
+                    TString path =
+                        pathSoFar + (pathSoFar.IsNull() ? "" : fPathSeparator) + physicalVolumeName;
+                    fGeant4AssemblyImprintToGdmlNameMap[imprint] = path;
+                    // Continue the assembly children chain with its correspondant godFatherAssembly and path
+                    ProcessNestedAssembliesRecursively(findElement(refName), newGodFatherAssemblyName, path);
+                } else if (ContainsAssemblies(refName)) {
+                    // its a regular logical volume
+                    // Regular children resets the godFatherAssembly and path
+                    ProcessNestedAssembliesRecursively(findElement(refName), "", "");
                 }
-                physicalVolumeNode = xml.GetNext(physicalVolumeNode);
             }
         };
 
-    // We loop a second time over the gdml structure to get the imprint of each assembly
+    // We go a second time over the gdml structure to get the imprint of each assembly
     // into fGeant4AssemblyImprintToGdmlNameMap: e.g. "av_2_impr_5" -> "shielding/vessel"
-    auto worldNode = myXml::GetChildByAttributeValue(xml, structure, "name", "world");
-    if (!worldNode) {
-        worldNode = myXml::GetChildByAttributeValue(xml, structure, "name", "World");
-        if (!worldNode) {
+    auto worldElement = findElement("world");
+    if (!worldElement) {
+        worldElement = findElement("World");
+        if (!worldElement) {
             cout << "Could not find world volume in GDML, please name it either 'World' or 'world'" << endl;
             exit(1);
         }
     }
     TString godFatherAssemblyName = "";  // the highest assembly volume in the nested chain
     TString pathSoFar = "";              // the path for the nested assemblies
-    ProcessNestedAssembliesRecursively(worldNode, godFatherAssemblyName, pathSoFar);
+    ProcessNestedAssembliesRecursively(worldElement, godFatherAssemblyName, pathSoFar);
 
-    // We loop a third time over gdml structure to get the physical and logical volumes names
+    // We go a third time over gdml structure to get the physical and logical volumes names
     map<TString, TString> nameTable;
     map<TString, vector<TString>> childrenTable;
-    child = xml.GetChild(structure);
-    while (child) {  // loop over the direct children of structure (logical volumes and assemblies)
-        TString name = xml.GetNodeName(child);  // name of the type of children: "volume" or "assembly"
-        TString volumeName = myXml::GetNodeAttribute(xml, child, "name");
-        auto physicalVolumeNode =
-            xml.GetChild(child);  // children of a volume or assembly are physical volumes
-        childrenTable[volumeName] = {};
-        while (physicalVolumeNode) {
-            auto physicalVolumeName = myXml::GetNodeAttribute(xml, physicalVolumeNode, "name");
-            auto volumeRefNode =
-                xml.GetChild(physicalVolumeNode);  // this are volumeref, position and rotation
-            while (volumeRefNode) {
-                TString volumeRefNodeName =
-                    xml.GetNodeName(volumeRefNode);  // "volumeref", "position" or "rotation"
-                if (volumeRefNodeName.EqualTo("volumeref")) {
-                    TString refName =
-                        myXml::GetNodeAttribute(xml, volumeRefNode, "ref");  // the logical volume name
-                    nameTable[physicalVolumeName] = refName;
-                    childrenTable[volumeName].push_back(physicalVolumeName);
-                    if (gdmlToGeant4AssemblyNameMap.count(refName) > 0) {
-                        fGeant4AssemblyImprintToAssemblyLogicalNameMap[physicalVolumeName] = refName;
-                    }
-                }
-                volumeRefNode = xml.GetNext(volumeRefNode);
+    for (const auto& element : elements) {
+        childrenTable[element.name] = {};
+        for (const auto& [physicalVolumeName, refName] : element.placements) {
+            nameTable[physicalVolumeName] = refName;
+            childrenTable[element.name].push_back(physicalVolumeName);
+            if (gdmlToGeant4AssemblyNameMap.count(refName) > 0) {
+                fGeant4AssemblyImprintToAssemblyLogicalNameMap[physicalVolumeName] = refName;
             }
-            physicalVolumeNode = xml.GetNext(physicalVolumeNode);
         }
-        child = xml.GetNext(child);
     }
 
     string worldVolumeName = "world";
@@ -271,8 +400,6 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
                                      childrenTable, topName, fPathSeparator);
     }
 
-    xml.FreeDoc(xmldoc);
-
     // Checks
     if (fGdmlNewPhysicalNames.empty()) {
         cout << "TRestGeant4GeometryInfo::PopulateFromGdml - ERROR - No physical volumes have been added!"
@@ -291,6 +418,10 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
         exit(1);
     }
 
+    if (!cacheFilename.IsNull()) {
+        SaveToGdmlCache(cacheFilename);
+    }
+
     /*
     // print gdmlToGeant4AssemblyNameMap
     cout << "GDML to Geant4 Assembly Name Map:" << endl;
@@ -325,34 +456,190 @@ void TRestGeant4GeometryInfo::PopulateFromGdml(const TString& gdmlFilename) {
     */
 }
 
+void TRestGeant4PathTranslator::Insert(const string& pattern, const string& replacement) {
+    Int_t node = 0;
+    for (const char c : pattern) {
+        const auto it = fNodes[node].children.find(c);
+        if (it != fNodes[node].children.end()) {
+            node = it->second;
+            continue;
+        }
+        fNodes[node].children[c] = fNodes.size();
+        node = fNodes.size();
+        fNodes.emplace_back();
+    }
+    if (fNodes[node].replacement == -1) {
+        fNodes[node].replacement = fReplacements.size();
+        fReplacements.push_back(replacement);
+    } else {
+        fReplacements[fNodes[node].replacement] = replacement;
+    }
+}
+
+string TRestGeant4PathTranslator::Translate(const string& input) const {
+    if (IsEmpty()) {
+        return input;
+    }
+    string output;
+    output.reserve(input.size());
+    size_t position = 0;
+    while (position < input.size()) {
+        // longest pattern starting at position
+        Int_t node = 0;
+        Int_t replacement = -1;
+        size_t matchLength = 0;
+        for (size_t i = position; i < input.size(); i++) {
+            const auto it = fNodes[node].children.find(input[i]);
+            if (it == fNodes[node].children.end()) {
+                break;
+            }
+            node = it->second;
+            if (fNodes[node].replacement != -1) {
+                replacement = fNodes[node].replacement;
+                matchLength = i - position + 1;
+            }
+        }
+        if (replacement == -1) {
+            output += input[position++];
+        } else {
+            output += fReplacements[replacement];
+            position += matchLength;
+        }
+    }
+    return output;
+}
+
+const TString* TRestGeant4PathMemo::Find(const string& path) {
+    const auto it = fIndex.find(path);
+    if (it == fIndex.end()) {
+        return nullptr;
+    }
+    // most recently used entries are kept at the front
+    fEntries.splice(fEntries.begin(), fEntries, it->second);
+    return &it->second->second;
+}
+
+void TRestGeant4PathMemo::Insert(const string& path, const TString& translation) {
+    if (fIndex.count(path) > 0) {
+        return;  // inserted by another lookup in the meantime
+    }
+    fEntries.emplace_front(path, translation);
+    fIndex[path] = fEntries.begin();
+    if (fEntries.size() > fCapacity) {
+        fIndex.erase(fEntries.back().first);
+        fEntries.pop_back();
+    }
+}
+
+void TRestGeant4GeometryInfo::BuildPathTranslators() const {
+    fImprintTranslator.Clear();
+    for (const auto& [gvName, gdmlName] : fGeant4AssemblyImprintToGdmlNameMap) {
+        fImprintTranslator.Insert((gvName + "_").Data(), (gdmlName + fPathSeparator).Data());
+    }
+    fChildrenTranslator.Clear();
+    for (const auto& [gvImprint, assemblyLogicalName] : fGeant4AssemblyImprintToAssemblyLogicalNameMap) {
+        const auto children = fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap.find(assemblyLogicalName);
+        if (children == fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap.end()) {
+            continue;
+        }
+        for (const auto& [childGeant4Name, childGdmlName] : children->second) {
+            fChildrenTranslator.Insert((gvImprint + fPathSeparator + childGeant4Name).Data(),
+                                       (gvImprint + fPathSeparator + childGdmlName).Data());
+        }
+    }
+    {
+        lock_guard<mutex> lock(translatedPathsMutex);
+        fTranslatedPaths.Clear();
+    }
+    fPathTranslatorsValid.Set(true);
+}
+
+void TRestGeant4GeometryInfo::UpdatePathTranslators() const {
+    if (fPathTranslatorsValid.IsValid()) {
+        return;
+    }
+    lock_guard<mutex> lock(indicesMutex);
+    if (!fPathTranslatorsValid.IsValid()) {
+        BuildPathTranslators();
+    }
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// \brief Converts a Geant4 volume path to a GDML volume path. The path is
 /// the concatenation of the names of the nested volumes from the world to the desired volume.
 /// This method is meant to handle the conversion of assembly imprints names to the
 /// GDML assembly names used in the GDML file.
+///
+/// The conversion is done by two prefix tries built once from the assembly maps, one for the assembly
+/// imprints and one for the assembly children, and the last translated paths are memoized.
+///
 /// \param geant4Path The Geant4 volume path.
 /// \return The corresponding GDML volume path using the PV names defined in the GDML file.
 TString TRestGeant4GeometryInfo::GetAlternativePathFromGeant4Path(const TString& geant4Path) const {
-    std::string convertedPath = geant4Path.Data();
+    UpdatePathTranslators();
+
+    const string path = geant4Path.Data();
+    {
+        lock_guard<mutex> lock(translatedPathsMutex);
+        const TString* memo = fTranslatedPaths.Find(path);
+        if (memo != nullptr) {
+            return *memo;
+        }
+    }
+
     // convert the Geant4 assembly imprint convention to GDML name
     // e.g. av_1_impr_2_childLV_pv_1 → assemblyName/childLV_pv_1
-    for (const auto& [gvName, gdmlName] : fGeant4AssemblyImprintToGdmlNameMap) {
-        convertedPath = Replace(convertedPath, (gvName + "_").Data(), (gdmlName + fPathSeparator).Data());
-    }
-    // convert the children names inside assemblies to physical volume names in GDML
+    // then convert the children names inside assemblies to physical volume names in GDML
     // e.g. assemblyName/childLV_pv_1 → assemblyName/childPVname
-    for (const auto& [gvImprint, assemblyLogicalName] : fGeant4AssemblyImprintToAssemblyLogicalNameMap) {
-        auto gvImprintPosition = convertedPath.find(gvImprint.Data());
-        if (gvImprintPosition != std::string::npos) {
-            for (const auto& [childGeant4Name, childGdmlName] :
-                 fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap.at(assemblyLogicalName)) {
-                TString toReplace = gvImprint + fPathSeparator + childGeant4Name;
-                TString replaceBy = gvImprint + fPathSeparator + childGdmlName;
-                convertedPath = Replace(convertedPath, toReplace.Data(), replaceBy.Data());
-            }
-        }
+    const TString convertedPath = fChildrenTranslator.Translate(fImprintTranslator.Translate(path));
+
+    lock_guard<mutex> lock(translatedPathsMutex);
+    fTranslatedPaths.Insert(path, convertedPath);
+    return convertedPath;
+}
+
+void TRestGeant4GeometryInfo::InvalidateIndices() {
+    fNameIndicesValid.Set(false);
+    fPathTranslatorsValid.Set(false);
+    lock_guard<mutex> lock(translatedPathsMutex);
+    fTranslatedPaths.Clear();
+}
+
+void TRestGeant4GeometryInfo::BuildNameIndices() const {
+    fAlternativeNamesIndex.clear();
+    for (const auto& [alternativeName, geant4Name] : fNewPhysicalToGeant4PhysicalNameMap) {
+        fAlternativeNamesIndex[geant4Name.Data()].push_back(alternativeName);
+    }
+    fGdmlNamesIndex.clear();
+    for (const auto& name : fGdmlNewPhysicalNames) {
+        fGdmlNamesIndex.insert(name.Data());
     }
-    return TString(convertedPath);
+    fNameIndicesValid.Set(true);
+}
+
+///////////////////////////////////////////////////////////////////////////
+/// \brief Builds the indices of the lookups by name if they are not valid. They are built only once even
+/// if several threads look up names at the same time.
+///
+void TRestGeant4GeometryInfo::UpdateNameIndices() const {
+    if (fNameIndicesValid.IsValid()) {
+        return;
+    }
+    lock_guard<mutex> lock(indicesMutex);
+    if (!fNameIndicesValid.IsValid()) {
+        BuildNameIndices();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/// \brief Returns the alternative names of a Geant4 physical volume name, in the order of
+/// fNewPhysicalToGeant4PhysicalNameMap, or nullptr if it has none.
+///
+const vector<TString>* TRestGeant4GeometryInfo::FindAlternativeNames(
+    const TString& geant4PhysicalName) const {
+    UpdateNameIndices();
+    const auto it = fAlternativeNamesIndex.find(geant4PhysicalName.Data());
+    return it != fAlternativeNamesIndex.end() ? &it->second : nullptr;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -368,10 +655,9 @@ TString TRestGeant4GeometryInfo::GetAlternativePathFromGeant4Path(const TString&
 ///
 TString TRestGeant4GeometryInfo::GetAlternativeNameFromGeant4PhysicalName(
     const TString& geant4PhysicalName) const {
-    for (const auto& kv : fNewPhysicalToGeant4PhysicalNameMap) {
-        if (kv.second.EqualTo(geant4PhysicalName)) {
-            return kv.first;
-        }
+    const auto alternativeNames = FindAlternativeNames(geant4PhysicalName);
+    if (alternativeNames != nullptr) {
+        return alternativeNames->front();
     }
     return geant4PhysicalName;
 }
@@ -388,27 +674,35 @@ TString TRestGeant4GeometryInfo::GetAlternativeNameFromGeant4PhysicalName(
 ///
 set<TString> TRestGeant4GeometryInfo::GetAlternativeNamesFromGeant4PhysicalName(
     const TString& geant4PhysicalName) const {
-    set<TString> alternativeNames;
-    for (const auto& kv : fNewPhysicalToGeant4PhysicalNameMap) {
-        if (kv.second.EqualTo(geant4PhysicalName)) {
-            alternativeNames.insert(kv.first);
-        }
+    const auto alternativeNames = FindAlternativeNames(geant4PhysicalName);
+    if (alternativeNames != nullptr) {
+        return {alternativeNames->begin(), alternativeNames->end()};
     }
-    return alternativeNames;
+    return {};
+}
+
+///////////////////////////////////////////////////////////////////////////
+/// \brief Checks if a name is one of the physical volume names generated from the GDML file.
+///
+bool TRestGeant4GeometryInfo::IsValidGdmlName(const TString& volume) const {
+    UpdateNameIndices();
+    return fGdmlNamesIndex.count(volume.Data()) > 0;
 }
 
 TString TRestGeant4GeometryInfo::GetGeant4PhysicalNameFromAlternativeName(
     const TString& alternativeName) const {
-    if (fNewPhysicalToGeant4PhysicalNameMap.count(alternativeName) > 0) {
-        return fNewPhysicalToGeant4PhysicalNameMap.at(alternativeName);
+    const auto it = fNewPhysicalToGeant4PhysicalNameMap.find(alternativeName);
+    if (it != fNewPhysicalToGeant4PhysicalNameMap.end()) {
+        return it->second;
     }
     return "";
 }
 
 template <typename T, typename U>
 U GetOrDefaultMapValueFromKey(const map<T, U>* pMap, const T& key) {
-    if (pMap->count(key) > 0) {
-        return pMap->at(key);
+    const auto it = pMap->find(key);
+    if (it != pMap->end()) {
+        return it->second;
     }
     return {};
 }
@@ -418,13 +712,14 @@ TString TRestGeant4GeometryInfo::GetVolumeFromID(Int_t id) const {
 }
 
 Int_t TRestGeant4GeometryInfo::GetIDFromVolume(const TString& volumeName) const {
-    if (fVolumeNameReverseMap.count(volumeName) == 0) {
+    const auto it = fVolumeNameReverseMap.find(volumeName);
+    if (it == fVolumeNameReverseMap.end()) {
         // if we do not find the volume we return -1 instead of default (which is 0 and may be confusing)
         cout << "TRestGeant4GeometryInfo::GetIDFromVolume - volume '" << volumeName << "' not found in store!"
              << endl;
         return -1;
     }
-    return GetOrDefaultMapValueFromKey<TString, Int_t>(&fVolumeNameReverseMap, volumeName);
+    return it->second;
 }
 
 void TRestGeant4GeometryInfo::InsertVolumeName(Int_t id, const TString& volumeName) {
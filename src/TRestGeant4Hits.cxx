@@ -17,6 +17,9 @@
 
 #include "TRestGeant4Hits.h"
 
+#include <cmath>
+#include <cstring>
+
 #include "TRestGeant4Event.h"
 
 using namespace std;
@@ -33,13 +36,45 @@ void TRestGeant4Hits::RemoveG4Hits() {
     fProcessID.clear();
     fVolumeID.clear();
     fKineticEnergy.clear();
+    fMomentumDirection.clear();
+
+    fProcessIDCompact.clear();
+    fVolumeIDCompact.clear();
+    fMomentumDirectionCompact.clear();
+}
+
+///////////////////////////////////////////////
+/// \brief Appends a hit, as restG4 does for each step. Compact hits are expanded first.
+///
+void TRestGeant4Hits::AddG4Hit(const TVector3& position, Double_t energy, Double_t time, Int_t processID,
+                               Int_t volumeID, Double_t kineticEnergy, const TVector3& momentumDirection) {
+    Expand();
+    ClearEventHitsColumns();
+
+    AddHit(position, energy, time);
+    fProcessID.push_back(processID);
+    fVolumeID.push_back(volumeID);
+    fKineticEnergy.push_back(kineticEnergy);
+    fMomentumDirection.push_back(momentumDirection);
+}
+
+std::vector<Float_t>& TRestGeant4Hits::GetEnergyRef() {
+    ClearEventHitsColumns();
+    return fEnergy;
+}
+
+/// The hits columns of the event are a copy of the hits, they are dropped when the hits are modified
+void TRestGeant4Hits::ClearEventHitsColumns() {
+    if (fEvent != nullptr) {
+        fEvent->ClearHitsColumns();
+    }
 }
 
 Double_t TRestGeant4Hits::GetEnergyInVolume(Int_t volumeID) const {
     Double_t energy = 0;
 
     for (size_t n = 0; n < GetNumberOfHits(); n++) {
-        if (fVolumeID[n] == volumeID) {
+        if (GetVolumeId(n) == volumeID) {
             energy += GetEnergy(n);
         }
     }
@@ -51,7 +86,7 @@ TVector3 TRestGeant4Hits::GetMeanPositionInVolume(Int_t volumeID) const {
     TVector3 pos;
     Double_t energy = 0;
     for (size_t n = 0; n < GetNumberOfHits(); n++)
-        if (fVolumeID[n] == volumeID) {
+        if (GetVolumeId(n) == volumeID) {
             pos += GetPosition(n) * GetEnergy(n);
             energy += GetEnergy(n);
         }
@@ -67,7 +102,7 @@ TVector3 TRestGeant4Hits::GetMeanPositionInVolume(Int_t volumeID) const {
 
 TVector3 TRestGeant4Hits::GetFirstPositionInVolume(Int_t volumeID) const {
     for (size_t n = 0; n < GetNumberOfHits(); n++)
-        if (fVolumeID[n] == volumeID) return GetPosition(n);
+        if (GetVolumeId(n) == volumeID) return GetPosition(n);
 
     Double_t nan = TMath::QuietNaN();
     return {nan, nan, nan};
@@ -75,7 +110,7 @@ TVector3 TRestGeant4Hits::GetFirstPositionInVolume(Int_t volumeID) const {
 
 TVector3 TRestGeant4Hits::GetLastPositionInVolume(Int_t volumeID) const {
     for (int n = GetNumberOfHits() - 1; n >= 0; n--) {
-        if (fVolumeID[n] == volumeID) {
+        if (GetVolumeId(n) == volumeID) {
             return GetPosition(n);
         }
     }
@@ -86,7 +121,7 @@ TVector3 TRestGeant4Hits::GetLastPositionInVolume(Int_t volumeID) const {
 size_t TRestGeant4Hits::GetNumberOfHitsInVolume(Int_t volumeID) const {
     size_t result = 0;
     for (size_t n = 0; n < GetNumberOfHits(); n++) {
-        if (fVolumeID[n] == volumeID) {
+        if (GetVolumeId(n) == volumeID) {
             result++;
         }
     }
@@ -94,6 +129,10 @@ size_t TRestGeant4Hits::GetNumberOfHitsInVolume(Int_t volumeID) const {
 }
 
 TRestGeant4Metadata* TRestGeant4Hits::GetGeant4Metadata() const {
+    if (fGeant4Metadata != nullptr) {
+        // bound by TRestGeant4Event::InitializeReferences
+        return const_cast<TRestGeant4Metadata*>(fGeant4Metadata);
+    }
     const TRestGeant4Event* event;
     if (fTrack != nullptr) {
         event = fTrack->GetEvent();
@@ -115,3 +154,141 @@ TString TRestGeant4Hits::GetVolumeName(size_t n) const {
     const auto metadata = GetGeant4Metadata();
     return metadata == nullptr ? "" : metadata->GetGeant4GeometryInfo().GetVolumeFromID(GetVolumeId(n));
 }
+
+namespace {
+constexpr Double_t kOctahedralScale = 65535.;
+
+inline Double_t SignNotZero(Double_t value) { return value >= 0 ? 1. : -1.; }
+
+/// Keeps the `bits` most significant bits of the mantissa of `value`, rounding to the nearest. The
+/// zeroed low bits make the stored values much more compressible.
+Float_t TruncateMantissa(Float_t value, Int_t bits) {
+    if (bits >= 23 || !std::isfinite(value)) {
+        return value;
+    }
+    if (bits < 0) {
+        bits = 0;
+    }
+    UInt_t word;
+    std::memcpy(&word, &value, sizeof(word));
+    const UInt_t dropped = 23 - bits;
+    word += 1u << (dropped - 1);
+    word &= ~((1u << dropped) - 1);
+    std::memcpy(&value, &word, sizeof(word));
+    return value;
+}
+}  // namespace
+
+///////////////////////////////////////////////
+/// \brief Encodes a unit vector into two 16 bit values using the octahedral mapping. The maximum angular
+/// error is about 6.5e-5 rad.
+///
+/// The null vector is encoded as (0, 0). That corner of the octahedral map also represents (0, 0, -1),
+/// which is written as (65535, 65535) instead.
+///
+void TRestGeant4Hits::EncodeDirection(const TVector3& direction, UShort_t& u, UShort_t& v) {
+    const Double_t norm = TMath::Abs(direction.X()) + TMath::Abs(direction.Y()) + TMath::Abs(direction.Z());
+    if (norm == 0) {
+        u = 0;
+        v = 0;
+        return;
+    }
+    Double_t x = direction.X() / norm;
+    Double_t y = direction.Y() / norm;
+    if (direction.Z() < 0) {
+        const Double_t xFolded = (1 - TMath::Abs(y)) * SignNotZero(x);
+        y = (1 - TMath::Abs(x)) * SignNotZero(y);
+        x = xFolded;
+    }
+    u = UShort_t(TMath::Nint((x * 0.5 + 0.5) * kOctahedralScale));
+    v = UShort_t(TMath::Nint((y * 0.5 + 0.5) * kOctahedralScale));
+    if (u == 0 && v == 0) {
+        u = UShort_t(kOctahedralScale);
+        v = UShort_t(kOctahedralScale);
+    }
+}
+
+TVector3 TRestGeant4Hits::DecodeDirection(UShort_t u, UShort_t v) {
+    if (u == 0 && v == 0) {
+        return {0, 0, 0};
+    }
+    Double_t x = u / kOctahedralScale * 2 - 1;
+    Double_t y = v / kOctahedralScale * 2 - 1;
+    const Double_t z = 1 - TMath::Abs(x) - TMath::Abs(y);
+    if (z < 0) {
+        const Double_t xUnfolded = (1 - TMath::Abs(y)) * SignNotZero(x);
+        y = (1 - TMath::Abs(x)) * SignNotZero(y);
+        x = xUnfolded;
+    }
+    TVector3 direction(x, y, z);
+    return direction.Unit();
+}
+
+///////////////////////////////////////////////
+/// \brief Converts the hits into the compact storage form, which should be done right before writing.
+///
+/// Process and volume IDs are stored as 16 bit integers and momentum directions as two 16 bit
+/// octahedral-encoded values. Positions keep `positionMantissaBits` and times `timeMantissaBits` bits of
+/// mantissa (23 keeps full float precision), so the relative precision is 2^-bits. Energies are not
+/// modified.
+///
+/// The getters decode the compact form transparently, so compact hits read from a file are used as
+/// they are. Expand restores the full size members, which is only needed before modifying the hits.
+///
+/// \return false if an ID does not fit in 16 bits, in which case the hits are left unchanged.
+///
+bool TRestGeant4Hits::Compact(Int_t positionMantissaBits, Int_t timeMantissaBits) {
+    if (IsCompact() || GetNumberOfHits() == 0) {
+        return true;
+    }
+    for (size_t n = 0; n < GetNumberOfHits(); n++) {
+        if (fProcessID[n] < 0 || fProcessID[n] > 0xFFFF || fVolumeID[n] < 0 || fVolumeID[n] > 0xFFFF) {
+            RESTWarning << "TRestGeant4Hits::Compact - IDs do not fit in 16 bits, hits are not compacted"
+                        << RESTendl;
+            return false;
+        }
+    }
+
+    fProcessIDCompact.assign(fProcessID.begin(), fProcessID.end());
+    fVolumeIDCompact.assign(fVolumeID.begin(), fVolumeID.end());
+    fMomentumDirectionCompact.resize(2 * fMomentumDirection.size());
+    for (size_t n = 0; n < fMomentumDirection.size(); n++) {
+        EncodeDirection(fMomentumDirection[n], fMomentumDirectionCompact[2 * n],
+                        fMomentumDirectionCompact[2 * n + 1]);
+    }
+
+    for (size_t n = 0; n < GetNumberOfHits(); n++) {
+        fX[n] = TruncateMantissa(fX[n], positionMantissaBits);
+        fY[n] = TruncateMantissa(fY[n], positionMantissaBits);
+        fZ[n] = TruncateMantissa(fZ[n], positionMantissaBits);
+        fTime[n] = TruncateMantissa(fTime[n], timeMantissaBits);
+    }
+
+    fProcessID.clear();
+    fVolumeID.clear();
+    fMomentumDirection.clear();
+
+    return true;
+}
+
+///////////////////////////////////////////////
+/// \brief Restores the full size members from the compact storage form. It does nothing if the hits are
+/// not compact.
+///
+void TRestGeant4Hits::Expand() {
+    if (!IsCompact()) {
+        return;
+    }
+
+    fProcessID.assign(fProcessIDCompact.begin(), fProcessIDCompact.end());
+    fVolumeID.assign(fVolumeIDCompact.begin(), fVolumeIDCompact.end());
+    fMomentumDirection.resize(fMomentumDirectionCompact.size() / 2);
+    for (size_t n = 0; n < fMomentumDirection.size(); n++) {
+        fMomentumDirection[n] =
+            DecodeDirection(fMomentumDirectionCompact[2 * n], fMomentumDirectionCompact[2 * n + 1]);
+    }
+
+    fProcessIDCompact.clear();
+    fVolumeIDCompact.clear();
+    fMomentumDirectionCompact.clear();
+}
@@ -752,6 +752,8 @@
 #include <TRestGDMLParser.h>
 #include <TRestRun.h>
 
+#include <mutex>
+
 #include "TRestGeant4ParticleSourceCosmics.h"
 #include "TRestGeant4PrimaryGeneratorInfo.h"
 
@@ -760,6 +762,10 @@ using namespace TRestGeant4PrimaryGeneratorTypes;
 
 ClassImp(TRestGeant4Metadata);
 
+namespace {
+std::mutex activeVolumeIndexMutex;
+}  // namespace
+
 ///////////////////////////////////////////////
 /// \brief Default constructor
 ///
@@ -800,6 +806,7 @@ void TRestGeant4Metadata::Initialize() {
 
     fChance.clear();
     fActiveVolumes.clear();
+    fActiveVolumeIndexValid = false;
     fBiasingVolumes.clear();
 
     RemoveParticleSources();
@@ -1530,6 +1537,8 @@ void TRestGeant4Metadata::ReadDetector() {
         RESTError << "No active volumes defined. Please check the detector section" << RESTendl;
         exit(1);
     }
+
+    BuildActiveVolumeIndex();
 }
 
 ///////////////////////////////////////////////
@@ -1607,13 +1616,42 @@ void TRestGeant4Metadata::PrintMetadata() {
 }
 
 ///////////////////////////////////////////////
-/// \brief Returns the id of an active volume giving as parameter its name.
-Int_t TRestGeant4Metadata::GetActiveVolumeID(const TString& name) {
-    Int_t id;
-    for (id = 0; id < (Int_t)fActiveVolumes.size(); id++) {
-        if (fActiveVolumes[id] == name) return id;
+/// \brief Rebuilds the hash index of the active volume names, see fActiveVolumeIndex.
+///
+void TRestGeant4Metadata::BuildActiveVolumeIndex() const {
+    fActiveVolumeIndex.clear();
+    fActiveVolumeIndexIgnoreCase.clear();
+    fActiveVolumeIndex.reserve(fActiveVolumes.size());
+    fActiveVolumeIndexIgnoreCase.reserve(fActiveVolumes.size());
+    for (Int_t id = 0; id < (Int_t)fActiveVolumes.size(); id++) {
+        // emplace keeps the first occurrence, as the former linear lookups did
+        fActiveVolumeIndex.emplace(fActiveVolumes[id].Data(), id);
+        fActiveVolumeIndexIgnoreCase.emplace(ToLower(fActiveVolumes[id].Data()), id);
     }
-    return -1;
+    fActiveVolumeIndexValid = true;
+}
+
+///////////////////////////////////////////////
+/// \brief Builds the active volume index if it is not valid. Lookups may run concurrently (Geant4 worker
+/// threads), so the index is built only once, under a lock. Changes to the active volumes
+/// (SetActiveVolume) are not synchronized, they are only done while reading the configuration.
+///
+void TRestGeant4Metadata::UpdateActiveVolumeIndex() const {
+    if (fActiveVolumeIndexValid) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(activeVolumeIndexMutex);
+    if (!fActiveVolumeIndexValid) {
+        BuildActiveVolumeIndex();
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the id of an active volume giving as parameter its name.
+Int_t TRestGeant4Metadata::GetActiveVolumeID(const TString& name) const {
+    UpdateActiveVolumeIndex();
+    const auto it = fActiveVolumeIndex.find(name.Data());
+    return it != fActiveVolumeIndex.end() ? it->second : -1;
 }
 
 ///////////////////////////////////////////////
@@ -1631,18 +1669,19 @@ Int_t TRestGeant4Metadata::GetActiveVolumeID(const TString& name) {
 /// of interest will be always registered (chance=1).
 ///
 void TRestGeant4Metadata::SetActiveVolume(const TString& name, Double_t chance, Double_t maxStep) {
-    for (size_t i = 0; i < fActiveVolumes.size(); i++) {
-        const auto activeVolumeName = fActiveVolumes[i];
-        if (name == activeVolumeName) {
-            fChance[i] = chance;
-            fMaxStepSize[i] = maxStep;
-            return;
-        }
+    const Int_t id = GetActiveVolumeID(name);
+    if (id >= 0) {
+        fChance[id] = chance;
+        fMaxStepSize[id] = maxStep;
+        return;
     }
     fActiveVolumes.push_back(name);
     fChance.push_back(chance);
     fMaxStepSize.push_back(maxStep);
     fActiveVolumesSet.insert(name.Data());
+
+    fActiveVolumeIndex.emplace(name.Data(), fActiveVolumes.size() - 1);
+    fActiveVolumeIndexIgnoreCase.emplace(ToLower(name.Data()), fActiveVolumes.size() - 1);
 }
 
 double TRestGeant4Metadata::GetGeneratorSurfaceCm2() const {
@@ -1666,25 +1705,16 @@ double TRestGeant4Metadata::GetGeneratorSurfaceCm2() const {
 /// data storage.
 ///
 Bool_t TRestGeant4Metadata::isVolumeStored(const TString& volume) const {
-    for (unsigned int n = 0; n < GetNumberOfActiveVolumes(); n++) {
-        if (GetActiveVolumeName(n) == volume) {
-            return true;
-        }
-    }
-
-    return false;
+    return GetActiveVolumeID(volume) >= 0;
 }
 
 ///////////////////////////////////////////////
 /// \brief Returns the probability of an active volume being stored
 ///
 Double_t TRestGeant4Metadata::GetStorageChance(const TString& volume) {
-    for (auto id = 0; id < (Int_t)fActiveVolumes.size(); id++) {
-        {
-            if (fActiveVolumes[id] == volume) {
-                return fChance[id];
-            }
-        }
+    const Int_t id = GetActiveVolumeID(volume);
+    if (id >= 0) {
+        return fChance[id];
     }
     RESTWarning << "TRestGeant4Metadata::GetStorageChance. Volume " << volume << " not found" << RESTendl;
 
@@ -1695,10 +1725,11 @@ Double_t TRestGeant4Metadata::GetStorageChance(const TString& volume) {
 /// \brief Returns the maximum step at a particular active volume
 ///
 Double_t TRestGeant4Metadata::GetMaxStepSize(const TString& volume) {
-    for (Int_t i = 0; i < (Int_t)fActiveVolumes.size(); i++) {
-        if (volume.EqualTo(fActiveVolumes[i], TString::kIgnoreCase)) {
-            return fMaxStepSize[i];
-        }
+    UpdateActiveVolumeIndex();
+    // volume names are compared ignoring case
+    const auto it = fActiveVolumeIndexIgnoreCase.find(ToLower(volume.Data()));
+    if (it != fActiveVolumeIndexIgnoreCase.end()) {
+        return fMaxStepSize[it->second];
     }
     RESTWarning << "TRestGeant4Metadata::GetMaxStepSize. Volume " << volume << " not found" << RESTendl;
 
@@ -1742,6 +1773,7 @@ TRestGeant4Metadata& TRestGeant4Metadata::operator=(const TRestGeant4Metadata& m
     fActiveVolumes = metadata.fActiveVolumes;
     fChance = metadata.fChance;
     fMaxStepSize = metadata.fMaxStepSize;
+    BuildActiveVolumeIndex();
     // fParticleSource = metadata.fParticleSource; // segfaults (pointers!)
     fNBiasingVolumes = metadata.fNBiasingVolumes;
     fBiasingVolumes = metadata.fBiasingVolumes;
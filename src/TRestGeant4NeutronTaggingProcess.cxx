@@ -87,6 +87,8 @@
 
 #include "TRestGeant4NeutronTaggingProcess.h"
 
+#include <algorithm>
+
 using namespace std;
 
 ClassImp(TRestGeant4NeutronTaggingProcess);
@@ -101,7 +103,7 @@ TRestGeant4NeutronTaggingProcess::TRestGeant4NeutronTaggingProcess(const char* c
 ///////////////////////////////////////////////
 /// \brief Default destructor
 ///
-TRestGeant4NeutronTaggingProcess::~TRestGeant4NeutronTaggingProcess() { delete fOutputG4Event; }
+TRestGeant4NeutronTaggingProcess::~TRestGeant4NeutronTaggingProcess() = default;
 
 ///////////////////////////////////////////////
 /// \brief Function to load the default config in absence of RML input
@@ -118,8 +120,9 @@ void TRestGeant4NeutronTaggingProcess::Initialize() {
     SetSectionName(this->ClassName());
     SetLibraryVersion(LIBRARY_VERSION);
 
+    // read-only process, the input event is passed through (see ProcessEvent)
     fInputG4Event = nullptr;
-    fOutputG4Event = new TRestGeant4Event();
+    fOutputG4Event = nullptr;
 }
 
 ///////////////////////////////////////////////
@@ -144,6 +147,14 @@ void TRestGeant4NeutronTaggingProcess::LoadConfig(const string& configFilename,
 void TRestGeant4NeutronTaggingProcess::InitProcess() {
     fG4Metadata = GetMetadata<TRestGeant4Metadata>();
 
+    const auto& physicsInfo = fG4Metadata->GetGeant4PhysicsInfo();
+    fNeutronID = physicsInfo.FindParticleID("neutron");
+    fGammaID = physicsInfo.FindParticleID("gamma");
+    fElectronID = physicsInfo.FindParticleID("e-");
+    fPositronID = physicsInfo.FindParticleID("e+");
+    fNeutronCaptureProcessID = physicsInfo.FindProcessID("nCapture");
+    fTransportationProcessID = physicsInfo.FindProcessID("Transportation");
+
     // CAREFUL THIS METHOD IS CALLED TWICE!
     // we need to reset these variables to zero
     Reset();
@@ -176,9 +187,185 @@ void TRestGeant4NeutronTaggingProcess::InitProcess() {
         }
     }
 
+    fVetoIndexByVolumeID.clear();
+    for (size_t vetoIndex = 0; vetoIndex < fVetoVolumeIds.size(); vetoIndex++) {
+        const int volumeID = fVetoVolumeIds[vetoIndex];
+        if (volumeID >= int(fVetoIndexByVolumeID.size())) {
+            fVetoIndexByVolumeID.resize(volumeID + 1, -1);
+        }
+        fVetoIndexByVolumeID[volumeID] = vetoIndex;
+    }
+
+    BuildVetoObservableNames();
+
     PrintMetadata();
 }
 
+///////////////////////////////////////////////
+/// \brief It builds the veto lookup tables and the names of all the veto energy observables,
+/// so that ProcessEvent does not need to handle any string.
+///
+void TRestGeant4NeutronTaggingProcess::BuildVetoObservableNames() {
+    const size_t numberOfVetoes = fVetoVolumeIds.size();
+    const size_t numberOfGroups = fVetoGroupVolumeNames.size();
+
+    const auto& geometryInfo = fG4Metadata->GetGeant4GeometryInfo();
+    std::map<string, size_t> vetoIndexByName;
+    fVetoVolumeNames.clear();
+    fVetoGeometryIDs.clear();
+    for (size_t vetoIndex = 0; vetoIndex < numberOfVetoes; vetoIndex++) {
+        fVetoVolumeNames.push_back((string)fG4Metadata->GetActiveVolumeName(fVetoVolumeIds[vetoIndex]));
+        vetoIndexByName[fVetoVolumeNames.back()] = vetoIndex;
+        const TString name = fVetoVolumeNames.back();
+        fVetoGeometryIDs.push_back(geometryInfo.HasVolumeID(name) ? geometryInfo.GetIDFromVolume(name) : -1);
+    }
+    // observables are set in alphabetical order of the veto names
+    fVetoIndicesByName.clear();
+    for (const auto& [name, vetoIndex] : vetoIndexByName) {
+        fVetoIndicesByName.push_back(vetoIndex);
+    }
+
+    fVetoGroupIndices.clear();
+    std::vector<string> groupNames;
+    for (const auto& [keyword, volumeNames] : fVetoGroupVolumeNames) {
+        fVetoGroupIndices.emplace_back();
+        for (const auto& volumeName : volumeNames) {
+            fVetoGroupIndices.back().push_back(vetoIndexByName.at(volumeName));
+        }
+        // convert to Upper + lower case (VetoGroupTopEVetoMax, ...)
+        string groupName;
+        for (auto it = keyword.cbegin(); it != keyword.cend(); ++it) {
+            if (it == keyword.cbegin()) {
+                groupName += std::toupper(*it);
+            } else {
+                groupName += std::tolower(*it);
+            }
+        }
+        groupNames.push_back(groupName);
+    }
+
+    std::vector<string> suffixes = {""};
+    for (const auto& quenchingFactor : fQuenchingFactors) {
+        string quenchingFactorString = std::to_string(quenchingFactor);
+        // replace "." in string by "_" because its gives very strange problems
+        quenchingFactorString.replace(quenchingFactorString.find("."), sizeof(".") - 1, "_");
+        suffixes.push_back("Qf" + quenchingFactorString);
+    }
+
+    fVetoEDepObservables.clear();
+    fVetoAllEVetoMaxObservables.clear();
+    fVetoGroupEVetoMaxObservables.clear();
+    for (const auto& suffix : suffixes) {
+        for (size_t vetoIndex = 0; vetoIndex < numberOfVetoes; vetoIndex++) {
+            fVetoEDepObservables.push_back(fVetoVolumeNames[vetoIndex] + "VolumeEDep" + suffix);
+        }
+        fVetoAllEVetoMaxObservables.push_back("vetoAllEVetoMax" + suffix);
+        for (size_t groupIndex = 0; groupIndex < numberOfGroups; groupIndex++) {
+            fVetoGroupEVetoMaxObservables.push_back("vetoGroup" + groupNames[groupIndex] + "EVetoMax" +
+                                                    suffix);
+        }
+    }
+
+    fVetoEnergy.assign(numberOfVetoes, 0);
+}
+
+///////////////////////////////////////////////
+/// \brief It sets the energy of each veto, the maximum over all vetoes and the maximum of each
+/// veto group from the energies in fVetoEnergy, using the observable names of the given set.
+///
+void TRestGeant4NeutronTaggingProcess::SetVetoEnergyObservables(size_t observableSet) {
+    const size_t numberOfVetoes = fVetoVolumeIds.size();
+    const size_t numberOfGroups = fVetoGroupIndices.size();
+
+    Double_t energyVetoMax = 0;
+    for (const auto vetoIndex : fVetoIndicesByName) {
+        const Double_t vetoEnergy = fVetoEnergy[vetoIndex];
+        SetObservableValue(fVetoEDepObservables[observableSet * numberOfVetoes + vetoIndex], vetoEnergy);
+        energyVetoMax = std::max(energyVetoMax, vetoEnergy);
+    }
+    SetObservableValue(fVetoAllEVetoMaxObservables[observableSet], energyVetoMax);
+
+    for (size_t groupIndex = 0; groupIndex < numberOfGroups; groupIndex++) {
+        Double_t energyVetoMaxGroup = 0;
+        for (const auto vetoIndex : fVetoGroupIndices[groupIndex]) {
+            energyVetoMaxGroup = std::max(energyVetoMaxGroup, fVetoEnergy[vetoIndex]);
+        }
+        SetObservableValue(fVetoGroupEVetoMaxObservables[observableSet * numberOfGroups + groupIndex],
+                           energyVetoMaxGroup);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It visits the hits of the event once, splitting the energy of each veto into its
+/// electromagnetic and nuclear parts (when quenching factors are given) and, if the event has
+/// neutron captures, collecting the hits in the vetoes sorted by the pre-order position of their
+/// track (see fVetoDeposits). Only the hits in the vetoes are stored, so the memory and time are
+/// proportional to the number of tracks and hits, not to tracks times vetoes.
+///
+void TRestGeant4NeutronTaggingProcess::BuildVetoDeposits(bool withCaptures) {
+    const size_t numberOfTracks = fOutputG4Event->GetNumberOfTracks();
+    const size_t numberOfVetoes = fVetoVolumeIds.size();
+    const Int_t numberOfIndexedVolumes = fVetoIndexByVolumeID.size();
+    const bool withQuenching = !fQuenchingFactors.empty();
+
+    fVetoElectromagneticEnergy.assign(numberOfVetoes, 0);
+    fVetoNuclearEnergy.assign(numberOfVetoes, 0);
+    fVetoDeposits.clear();
+    fVetoDepositOffsets.assign(numberOfTracks + 1, 0);
+    fTrackEnergy.resize(numberOfTracks);
+    if (!withQuenching && !withCaptures) {
+        return;
+    }
+
+    // hits are first stored by track index, and then sorted by pre-order position (counting sort)
+    vector<std::pair<Int_t, Double_t>> depositsByTrack;
+    vector<size_t> depositsPerTrack(numberOfTracks, 0);
+    for (size_t trackIndex = 0; trackIndex < numberOfTracks; trackIndex++) {
+        const auto& track = fOutputG4Event->GetTrack(trackIndex);
+        fTrackEnergy[trackIndex] = track.GetTotalEnergy();
+        auto& vetoEnergy = (track.IsParticle(fElectronID, "e-") || track.IsParticle(fPositronID, "e+") ||
+                            track.IsParticle(fGammaID, "gamma"))
+                               ? fVetoElectromagneticEnergy
+                               : fVetoNuclearEnergy;
+
+        const auto& hits = track.GetHits();
+        for (size_t n = 0; n < hits.GetNumberOfHits(); n++) {
+            const Int_t volumeID = hits.GetVolumeId(n);
+            if (volumeID < 0 || volumeID >= numberOfIndexedVolumes || fVetoIndexByVolumeID[volumeID] < 0) {
+                continue;
+            }
+            const Int_t vetoIndex = fVetoIndexByVolumeID[volumeID];
+            const Double_t energy = hits.GetEnergy(n);
+            if (withQuenching) {
+                vetoEnergy[vetoIndex] += energy;
+            }
+            if (withCaptures && energy != 0) {
+                depositsByTrack.emplace_back(vetoIndex, energy);
+                depositsPerTrack[trackIndex]++;
+            }
+        }
+    }
+    if (!withCaptures) {
+        return;
+    }
+
+    for (size_t trackIndex = 0; trackIndex < numberOfTracks; trackIndex++) {
+        fVetoDepositOffsets[fOutputG4Event->GetTrackPreOrder(trackIndex) + 1] = depositsPerTrack[trackIndex];
+    }
+    for (size_t position = 0; position < numberOfTracks; position++) {
+        fVetoDepositOffsets[position + 1] += fVetoDepositOffsets[position];
+    }
+    fVetoDeposits.resize(depositsByTrack.size());
+    size_t trackBegin = 0;
+    for (size_t trackIndex = 0; trackIndex < numberOfTracks; trackIndex++) {
+        const size_t begin = fVetoDepositOffsets[fOutputG4Event->GetTrackPreOrder(trackIndex)];
+        std::copy(depositsByTrack.begin() + trackBegin,
+                  depositsByTrack.begin() + trackBegin + depositsPerTrack[trackIndex],
+                  fVetoDeposits.begin() + begin);
+        trackBegin += depositsPerTrack[trackIndex];
+    }
+}
+
 void TRestGeant4NeutronTaggingProcess::Reset() {
     /*
     fVetoVolumeIds.clear();
@@ -219,192 +406,104 @@ void TRestGeant4NeutronTaggingProcess::Reset() {
 ///
 TRestEvent* TRestGeant4NeutronTaggingProcess::ProcessEvent(TRestEvent* inputEvent) {
     fInputG4Event = (TRestGeant4Event*)inputEvent;
-    *fOutputG4Event = *((TRestGeant4Event*)inputEvent);
+    // the event is not modified, there is no need to copy it
+    fOutputG4Event = fInputG4Event;
 
     Reset();
-    std::map<string, Double_t> volume_energy_map;
-
-    for (unsigned int i = 0; i < fVetoVolumeIds.size(); i++) {
-        int id = fVetoVolumeIds[i];
-        string volume_name = (string)fG4Metadata->GetActiveVolumeName(id);
-
-        Double_t energy = fOutputG4Event->GetEnergyInVolume(volume_name);
-        volume_energy_map[volume_name] = energy;
-    }
-
-    Double_t energy_veto_max = 0;
-    for (const auto& pair : volume_energy_map) {
-        Double_t veto_energy = pair.second;
-        SetObservableValue(pair.first + "VolumeEDep", veto_energy);
-        if (veto_energy > energy_veto_max) {
-            energy_veto_max = veto_energy;
-        };
+    const auto neutronCaptures = fOutputG4Event->GetProcessOccurrences(fNeutronCaptureProcessID);
+    BuildVetoDeposits(!neutronCaptures.empty());
+    const size_t numberOfVetoes = fVetoVolumeIds.size();
+
+    for (size_t vetoIndex = 0; vetoIndex < numberOfVetoes; vetoIndex++) {
+        const Int_t volumeID = fVetoGeometryIDs[vetoIndex];
+        fVetoEnergy[vetoIndex] =
+            volumeID >= 0 ? fOutputG4Event->GetEnergyInVolume(volumeID)
+                          : fOutputG4Event->GetEnergyInVolume(fVetoVolumeNames[vetoIndex]);
     }
-    SetObservableValue("vetoAllEVetoMax", energy_veto_max);
-
-    // veto groups
-    for (const auto& pair : fVetoGroupVolumeNames) {
-        Double_t energy_veto_max_group = 0;
-        for (unsigned int i = 0; i < pair.second.size(); i++) {
-            string volume_name = pair.second[i];
-            Double_t veto_energy = volume_energy_map[volume_name];
-            if (veto_energy > energy_veto_max_group) {
-                energy_veto_max_group = veto_energy;
-            };
+    SetVetoEnergyObservables(0);
+
+    // quenched energy is linear in the quenching factor, so the energy of each veto is split only once
+    // into the electromagnetic (not quenched) and the nuclear (quenched) parts, see BuildVetoDeposits
+    for (size_t quenchingIndex = 0; quenchingIndex < fQuenchingFactors.size(); quenchingIndex++) {
+        const Float_t quenchingFactor = fQuenchingFactors[quenchingIndex];
+        for (size_t vetoIndex = 0; vetoIndex < numberOfVetoes; vetoIndex++) {
+            fVetoEnergy[vetoIndex] =
+                fVetoElectromagneticEnergy[vetoIndex] + quenchingFactor * fVetoNuclearEnergy[vetoIndex];
         }
-        // convert to Upper + lower case (VetoGroupTopEVetoMax, ...)
-        string group_name;
-        for (auto it = pair.first.cbegin(); it != pair.first.cend(); ++it) {
-            if (it == pair.first.cbegin()) {
-                group_name += std::toupper(*it);
-            } else {
-                group_name += std::tolower(*it);
-            }
-        }
-        SetObservableValue("vetoGroup" + group_name + "EVetoMax", energy_veto_max_group);
+        SetVetoEnergyObservables(quenchingIndex + 1);
     }
 
-    //
-
-    for (const auto& quenching_factor : fQuenchingFactors) {
-        string quenching_factor_string = std::to_string(quenching_factor);
-        // replace "." in string by "_" because its gives very strange problems
-        quenching_factor_string =
-            quenching_factor_string.replace(quenching_factor_string.find("."), sizeof(".") - 1, "_");
-        volume_energy_map.clear();
-        for (unsigned int i = 0; i < fOutputG4Event->GetNumberOfTracks(); i++) {
-            const auto& track = fOutputG4Event->GetTrack(i);
-            string particle_name = (string)track.GetParticleName();
-            for (const auto& id : fVetoVolumeIds) {
-                string volume_name = (string)fG4Metadata->GetActiveVolumeName(id);
-
-                if (particle_name == "e-" || particle_name == "e+" || particle_name == "gamma") {
-                    // no quenching factor
-                    volume_energy_map[volume_name] += track.GetEnergyInVolume(id);
-                } else {
-                    // apply quenching factor
-                    volume_energy_map[volume_name] += quenching_factor * track.GetEnergyInVolume(id);
-                }
+    std::set<int> neutronsCaptured = {};
+    // only the neutron capture hits are visited, through the per-event process index
+    for (const auto& [trackIndex, j] : neutronCaptures) {
+        const auto& track = fOutputG4Event->GetTrack(trackIndex);
+        if (!track.IsParticle(fNeutronID, "neutron")) {
+            continue;
+        }
+        const auto& hits = track.GetHits();
+        // << "Neutron capture!!!!!! " << particle_name << "trackId " << track.GetTrackID()
+        //    << " hit " << j << endl;
+        // track.PrintTrack();
+        // hits.PrintHits(j + 1);
+
+        neutronsCaptured.insert(track.GetTrackID());
+
+        fNeutronsCapturedNumber += 1;
+        fNeutronsCapturedPosX.push_back(hits.GetX(j));
+        fNeutronsCapturedPosY.push_back(hits.GetY(j));
+        fNeutronsCapturedPosZ.push_back(hits.GetZ(j));
+
+        Int_t volumeId = hits.GetVolumeId(j);
+        Int_t isCaptureVolume = 0;
+        for (const auto& id : fCaptureVolumeIds) {
+            if (volumeId == id) {
+                isCaptureVolume = 1;
+                continue;
             }
         }
-
-        Double_t energy_veto_max = 0;
-        for (const auto& pair : volume_energy_map) {
-            Double_t veto_energy = pair.second;
-            SetObservableValue(pair.first + "VolumeEDep" + "Qf" + quenching_factor_string, veto_energy);
-            if (veto_energy > energy_veto_max) {
-                energy_veto_max = veto_energy;
-            };
+        fNeutronsCapturedIsCaptureVolume.push_back(isCaptureVolume);
+        fNeutronsCapturedProductionE.push_back(track.GetInitialKineticEnergy());
+
+        // get energy deposited by neutron that undergoes capture and children. The neutron and its
+        // descendants are the pre-order range [pre, post), their hits in the vetoes are contiguous
+        const Int_t preOrder = fOutputG4Event->GetTrackPreOrder(trackIndex);
+        const Int_t postOrder = fOutputG4Event->GetTrackPostOrder(trackIndex);
+        const auto& tracksInPreOrder = fOutputG4Event->GetTracksInPreOrder();
+
+        double neutronsCapturedEDepByNeutron = fTrackEnergy[trackIndex];
+        double neutronsCapturedEDepByNeutronAndChildren = 0;
+        for (Int_t position = preOrder; position < postOrder; position++) {
+            neutronsCapturedEDepByNeutronAndChildren += fTrackEnergy[tracksInPreOrder[position]];
         }
-        SetObservableValue(string("vetoAllEVetoMax") + "Qf" + quenching_factor_string, energy_veto_max);
-
-        // veto groups
-        for (const auto& pair : fVetoGroupVolumeNames) {
-            Double_t energy_veto_max_group = 0;
-            for (unsigned int i = 0; i < pair.second.size(); i++) {
-                string volume_name = pair.second[i];
-                Double_t veto_energy = volume_energy_map[volume_name];
-                if (veto_energy > energy_veto_max_group) {
-                    energy_veto_max_group = veto_energy;
-                };
-            }
-            // convert to Upper + lower case (VetoGroupTopEVetoMax, ...)
-            string group_name;
-            for (auto it = pair.first.cbegin(); it != pair.first.cend(); ++it) {
-                if (it == pair.first.cbegin()) {
-                    group_name += std::toupper(*it);
-                } else {
-                    group_name += std::tolower(*it);
-                }
+        double neutronsCapturedEDepByNeutronInVeto = 0;
+        double neutronsCapturedEDepByNeutronAndChildrenInVeto = 0;
+        fSubtreeEnergyInVeto.assign(numberOfVetoes, 0);
+        for (size_t n = fVetoDepositOffsets[preOrder]; n < fVetoDepositOffsets[postOrder]; n++) {
+            const auto& [vetoIndex, energy] = fVetoDeposits[n];
+            if (n < fVetoDepositOffsets[preOrder + 1]) {
+                neutronsCapturedEDepByNeutronInVeto += energy;
             }
-            SetObservableValue("vetoGroup" + group_name + "EVetoMax" + "Qf" + quenching_factor_string,
-                               energy_veto_max_group);
+            neutronsCapturedEDepByNeutronAndChildrenInVeto += energy;
+            fSubtreeEnergyInVeto[vetoIndex] += energy;
         }
-    }
 
-    std::set<int> neutronsCaptured = {};
-    for (unsigned int i = 0; i < fOutputG4Event->GetNumberOfTracks(); i++) {
-        auto track = fOutputG4Event->GetTrack(i);
-        string particle_name = (string)track.GetParticleName();
-        if (particle_name == "neutron") {
-            auto hits = track.GetHits();
-            for (unsigned int j = 0; j < hits.GetNumberOfHits(); j++) {
-                string process_name = (string)track.GetProcessName(hits.GetProcess(j));
-                if (process_name == "nCapture") {
-                    // << "Neutron capture!!!!!! " << particle_name << "trackId " << track.GetTrackID()
-                    //    << " hit " << j << endl;
-                    // track.PrintTrack();
-                    // hits.PrintHits(j + 1);
-
-                    neutronsCaptured.insert(track.GetTrackID());
-
-                    fNeutronsCapturedNumber += 1;
-                    fNeutronsCapturedPosX.push_back(hits.GetX(j));
-                    fNeutronsCapturedPosY.push_back(hits.GetY(j));
-                    fNeutronsCapturedPosZ.push_back(hits.GetZ(j));
-
-                    Int_t volumeId = hits.GetVolumeId(j);
-                    Int_t isCaptureVolume = 0;
-                    for (const auto& id : fCaptureVolumeIds) {
-                        if (volumeId == id) {
-                            isCaptureVolume = 1;
-                            continue;
-                        }
-                    }
-                    fNeutronsCapturedIsCaptureVolume.push_back(isCaptureVolume);
-                    fNeutronsCapturedProductionE.push_back(track.GetInitialKineticEnergy());
-
-                    // get energy deposited by neutron that undergoes capture and children
-                    double neutronsCapturedEDepByNeutron = 0;
-                    double neutronsCapturedEDepByNeutronAndChildren = 0;
-                    double neutronsCapturedEDepByNeutronInVeto = 0;
-                    double neutronsCapturedEDepByNeutronAndChildrenInVeto = 0;
-
-                    std::set<int> parents = {track.GetTrackID()};
-                    std::map<int, double> energyInVeto;
-                    for (unsigned int child = 0; child < fOutputG4Event->GetNumberOfTracks(); child++) {
-                        const auto& trackChild = fOutputG4Event->GetTrack(child);
-                        if ((parents.count(trackChild.GetParentID()) > 0) ||
-                            parents.count(trackChild.GetTrackID()) > 0) {
-                            // track or parent is in list of tracks, we add to list and add energy
-                            parents.insert(trackChild.GetTrackID());
-                            neutronsCapturedEDepByNeutronAndChildren += trackChild.GetTotalEnergy();
-                            if (trackChild.GetTrackID() == track.GetTrackID()) {
-                                neutronsCapturedEDepByNeutron += trackChild.GetTotalEnergy();
-                            }
-                            for (const auto& vetoId : fVetoVolumeIds) {
-                                neutronsCapturedEDepByNeutronAndChildrenInVeto +=
-                                    trackChild.GetEnergyInVolume(vetoId);
-                                energyInVeto[vetoId] += trackChild.GetEnergyInVolume(vetoId);
-                                if (trackChild.GetTrackID() == track.GetTrackID()) {
-                                    neutronsCapturedEDepByNeutronInVeto +=
-                                        trackChild.GetEnergyInVolume(vetoId);
-                                }
-                            }
-                        }
-                    }
-
-                    fNeutronsCapturedEDepByNeutron.push_back(neutronsCapturedEDepByNeutron);
-                    fNeutronsCapturedEDepByNeutronAndChildren.push_back(
-                        neutronsCapturedEDepByNeutronAndChildren);
-                    fNeutronsCapturedEDepByNeutronInVeto.push_back(neutronsCapturedEDepByNeutronInVeto);
-                    fNeutronsCapturedEDepByNeutronAndChildrenInVeto.push_back(
-                        neutronsCapturedEDepByNeutronAndChildrenInVeto);
-
-                    // get max and min energy in each veto (to compare with energy in ALL vetoes)
-                    double energyMaxVeto = 0;
-                    double energyMinVeto = -1;
-                    for (const auto& pair : energyInVeto) {
-                        auto E = pair.second;
-                        if (E > energyMaxVeto) energyMaxVeto = E;
-                        if (E < energyMaxVeto || energyMinVeto == -1) energyMinVeto = E;
-                    }
-
-                    fNeutronsCapturedEDepByNeutronAndChildrenInVetoMax.push_back(energyMaxVeto);
-                    fNeutronsCapturedEDepByNeutronAndChildrenInVetoMin.push_back(energyMinVeto);
-                }
-            }
+        fNeutronsCapturedEDepByNeutron.push_back(neutronsCapturedEDepByNeutron);
+        fNeutronsCapturedEDepByNeutronAndChildren.push_back(neutronsCapturedEDepByNeutronAndChildren);
+        fNeutronsCapturedEDepByNeutronInVeto.push_back(neutronsCapturedEDepByNeutronInVeto);
+        fNeutronsCapturedEDepByNeutronAndChildrenInVeto.push_back(
+            neutronsCapturedEDepByNeutronAndChildrenInVeto);
+
+        // get max and min energy in each veto (to compare with energy in ALL vetoes)
+        double energyMaxVeto = 0;
+        double energyMinVeto = -1;
+        for (size_t vetoIndex = 0; vetoIndex < numberOfVetoes; vetoIndex++) {
+            auto E = fSubtreeEnergyInVeto[vetoIndex];
+            if (E > energyMaxVeto) energyMaxVeto = E;
+            if (E < energyMaxVeto || energyMinVeto == -1) energyMinVeto = E;
         }
+
+        fNeutronsCapturedEDepByNeutronAndChildrenInVetoMax.push_back(energyMaxVeto);
+        fNeutronsCapturedEDepByNeutronAndChildrenInVetoMin.push_back(energyMinVeto);
     }
 
     SetObservableValue("neutronsCapturedNumber", fNeutronsCapturedNumber);
@@ -423,9 +522,8 @@ TRestEvent* TRestGeant4NeutronTaggingProcess::ProcessEvent(TRestEvent* inputEven
     SetObservableValue("neutronsCapturedEDepByNeutronAndChildrenInVetoMin",
                        fNeutronsCapturedEDepByNeutronAndChildrenInVetoMin);
     for (unsigned int i = 0; i < fOutputG4Event->GetNumberOfTracks(); i++) {
-        auto track = fOutputG4Event->GetTrack(i);
-        string particle_name = (string)track.GetParticleName();
-        if (particle_name == "gamma") {
+        const auto& track = fOutputG4Event->GetTrack(i);
+        if (track.IsParticle(fGammaID, "gamma")) {
             // check if gamma is child of captured neutron
             Int_t parent = track.GetParentID();
             if (neutronsCaptured.count(parent) > 0) {
@@ -462,54 +560,48 @@ TRestEvent* TRestGeant4NeutronTaggingProcess::ProcessEvent(TRestEvent* inputEven
     SetObservableValue("gammasNeutronCaptureProductionE", fGammasNeutronCaptureProductionE);
 
     std::set<int> secondaryNeutrons = {};  // avoid counting twice
-    for (unsigned int i = 0; i < fOutputG4Event->GetNumberOfTracks(); i++) {
-        auto track = fOutputG4Event->GetTrack(i);
-        string particle_name = (string)track.GetParticleName();
-        if (particle_name == "neutron" && track.GetParentID() != 0) {  // not consider primary
-            // check if neutron exits shielding
-            auto hits = track.GetHits();
-            for (unsigned int j = 0; j < hits.GetNumberOfHits(); j++) {
-                string process_name = (string)track.GetProcessName(hits.GetProcess(j));
-                if (process_name == "Transportation") {
-                    for (const auto& id : fShieldingVolumeIds) {
-                        if (hits.GetVolumeId(j) == id) {
-                            // transportation and shielding == exits shielding
-                            if (secondaryNeutrons.count(track.GetTrackID()) == 0) {
-                                // first time adding this secondary neutron
-                                secondaryNeutrons.insert(track.GetTrackID());
-                            } else {
-                                continue;
-                            }
-                            fSecondaryNeutronsShieldingNumber += 1;
-                            fSecondaryNeutronsShieldingExitPosX.push_back(hits.GetX(j));
-                            fSecondaryNeutronsShieldingExitPosY.push_back(hits.GetY(j));
-                            fSecondaryNeutronsShieldingExitPosZ.push_back(hits.GetZ(j));
-
-                            Int_t volumeId = hits.GetVolumeId(j);
-                            Int_t isCaptureVolume = 0;
-                            for (const auto& id : fCaptureVolumeIds) {
-                                if (volumeId == id) {
-                                    isCaptureVolume = 1;
-                                    continue;
-                                }
-                            }
-                            Int_t isCaptured = 0;
-                            if (neutronsCaptured.count(track.GetTrackID()) > 0) {
-                                isCaptured = 1;
-                            }
-                            fSecondaryNeutronsShieldingIsCaptured.push_back(isCaptured);
-                            if (isCaptured)
-                                fSecondaryNeutronsShieldingIsCapturedInCaptureVolume.push_back(
-                                    isCaptureVolume);
-                            else {
-                                fSecondaryNeutronsShieldingIsCapturedInCaptureVolume.push_back(0);
-                            }
-
-                            fSecondaryNeutronsShieldingProductionE.push_back(track.GetInitialKineticEnergy());
-                            fSecondaryNeutronsShieldingExitE.push_back(hits.GetKineticEnergy(j));
-                        }
+    for (const auto& [trackIndex, j] : fOutputG4Event->GetProcessOccurrences(fTransportationProcessID)) {
+        const auto& track = fOutputG4Event->GetTrack(trackIndex);
+        if (!track.IsParticle(fNeutronID, "neutron") || track.GetParentID() == 0) {  // not consider primary
+            continue;
+        }
+        // check if neutron exits shielding
+        const auto& hits = track.GetHits();
+        for (const auto& id : fShieldingVolumeIds) {
+            if (hits.GetVolumeId(j) == id) {
+                // transportation and shielding == exits shielding
+                if (secondaryNeutrons.count(track.GetTrackID()) == 0) {
+                    // first time adding this secondary neutron
+                    secondaryNeutrons.insert(track.GetTrackID());
+                } else {
+                    continue;
+                }
+                fSecondaryNeutronsShieldingNumber += 1;
+                fSecondaryNeutronsShieldingExitPosX.push_back(hits.GetX(j));
+                fSecondaryNeutronsShieldingExitPosY.push_back(hits.GetY(j));
+                fSecondaryNeutronsShieldingExitPosZ.push_back(hits.GetZ(j));
+
+                Int_t volumeId = hits.GetVolumeId(j);
+                Int_t isCaptureVolume = 0;
+                for (const auto& id : fCaptureVolumeIds) {
+                    if (volumeId == id) {
+                        isCaptureVolume = 1;
+                        continue;
                     }
                 }
+                Int_t isCaptured = 0;
+                if (neutronsCaptured.count(track.GetTrackID()) > 0) {
+                    isCaptured = 1;
+                }
+                fSecondaryNeutronsShieldingIsCaptured.push_back(isCaptured);
+                if (isCaptured)
+                    fSecondaryNeutronsShieldingIsCapturedInCaptureVolume.push_back(isCaptureVolume);
+                else {
+                    fSecondaryNeutronsShieldingIsCapturedInCaptureVolume.push_back(0);
+                }
+
+                fSecondaryNeutronsShieldingProductionE.push_back(track.GetInitialKineticEnergy());
+                fSecondaryNeutronsShieldingExitE.push_back(hits.GetKineticEnergy(j));
             }
         }
     }
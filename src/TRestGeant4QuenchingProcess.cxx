@@ -138,7 +138,7 @@ void TRestGeant4QuenchingProcess::InitProcess() {
         exit(1);
     }
 
-    const auto geometryInfo = fGeant4Metadata->GetGeant4GeometryInfo();
+    const auto& geometryInfo = fGeant4Metadata->GetGeant4GeometryInfo();
     // check all the user volume expressions are valid and correspond to at least a volume
     for (const auto& userVolume : fUserVolumeExpressions) {
         set<string> physicalVolumes = {};
@@ -166,19 +166,73 @@ void TRestGeant4QuenchingProcess::InitProcess() {
         }
     }
 
+    fQuenchedVolumeIDs.clear();
+    for (const auto& volume : fVolumes) {
+        if (!geometryInfo.HasVolumeID(volume)) {
+            continue;
+        }
+        const Int_t volumeID = geometryInfo.GetIDFromVolume(volume);
+        if (volumeID >= Int_t(fQuenchedVolumeIDs.size())) {
+            fQuenchedVolumeIDs.resize(volumeID + 1, false);
+        }
+        fQuenchedVolumeIDs[volumeID] = true;
+    }
+
+    BuildLindhardTables();
+
     RESTDebug << "TRestGeant4QuenchingProcess initialized with volumes" << RESTendl;
     for (const auto& volume : fVolumes) {
         RESTDebug << " " << volume << RESTendl;
     }
 }
 
-double QuenchingFactor(double recoilEnergy, int A, int Z) {
-    // Lindhard formula
-    double gamma = 11.5 * recoilEnergy * TMath::Power(Z, -7.0 / 3.0);
-    double g = 3 * TMath::Power(gamma, 0.15) + 0.7 * TMath::Power(gamma, 0.6) + gamma;
-    double k = 0.133 * TMath::Power(Z, 2.0 / 3.0) * TMath::Power(A, -1.0 / 2.0);
-    return k * g / (1 + k * g);
+TRestGeant4LindhardCoefficients::TRestGeant4LindhardCoefficients(Int_t A, Int_t Z)
+    : gammaPerEnergy(11.5 * TMath::Power(Z, -7.0 / 3.0)),
+      k(0.133 * TMath::Power(Z, 2.0 / 3.0) * TMath::Power(A, -1.0 / 2.0)) {}
+
+///////////////////////////////////////////////
+/// \brief Lindhard quenching factor of a nuclear recoil of the given energy (keV) on a target
+/// isotope (A, Z)
+///
+Double_t TRestGeant4QuenchingProcess::LindhardQuenchingFactor(Double_t recoilEnergy, Int_t A, Int_t Z) {
+    return TRestGeant4LindhardCoefficients(A, Z).Evaluate(recoilEnergy);
+}
+
+namespace {
+// tables cover all the known isotopes, others are computed when found
+constexpr Int_t lindhardTableMaxZ = 120;
+constexpr Int_t lindhardTableMaxA = 300;
+}  // namespace
+
+///////////////////////////////////////////////
+/// \brief It fills the tables of Lindhard coefficients by Z and A, so that finding the coefficients of
+/// the target isotope of a hit only needs two vector lookups
+///
+void TRestGeant4QuenchingProcess::BuildLindhardTables() {
+    fLindhardCoefficientsByZ.assign(lindhardTableMaxZ + 1, {});
+    for (Int_t Z = 1; Z <= lindhardTableMaxZ; Z++) {
+        fLindhardCoefficientsByZ[Z] = TRestGeant4LindhardCoefficients(1, Z);
+    }
+    fLindhardInverseSqrtA.assign(lindhardTableMaxA + 1, 0);
+    for (Int_t A = 1; A <= lindhardTableMaxA; A++) {
+        fLindhardInverseSqrtA[A] = TMath::Power(A, -1.0 / 2.0);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It returns the Lindhard coefficients of the isotope (A, Z), from the tables filled at
+/// InitProcess
+///
+TRestGeant4LindhardCoefficients TRestGeant4QuenchingProcess::GetLindhardCoefficients(Int_t A, Int_t Z) const {
+    if (Z < 1 || Z >= Int_t(fLindhardCoefficientsByZ.size()) || A < 1 ||
+        A >= Int_t(fLindhardInverseSqrtA.size())) {
+        return TRestGeant4LindhardCoefficients(A, Z);
+    }
+    TRestGeant4LindhardCoefficients coefficients = fLindhardCoefficientsByZ[Z];
+    coefficients.k *= fLindhardInverseSqrtA[A];
+    return coefficients;
 }
+
 ///////////////////////////////////////////////
 /// \brief The main processing event function
 ///
@@ -189,13 +243,15 @@ TRestEvent* TRestGeant4QuenchingProcess::ProcessEvent(TRestEvent* inputEvent) {
     const double sensitiveVolumeEnergyBefore = fOutputG4Event->GetSensitiveVolumeEnergy();
 
     fOutputG4Event->InitializeReferences(GetRunInfo());
-    fOutputG4Event->fEnergyInVolumePerParticlePerProcess.clear();
+    fOutputG4Event->ClearEnergyDeposits();
+
+    const Int_t numberOfQuenchedVolumeIDs = fQuenchedVolumeIDs.size();
 
     // loop over all tracks
     for (int trackIndex = 0; trackIndex < int(fOutputG4Event->GetNumberOfTracks()); trackIndex++) {
         // get the track
         TRestGeant4Track* track = fOutputG4Event->GetTrackPointer(trackIndex);
-        const auto& particleName = track->GetParticleName();
+        const Int_t particleID = track->GetParticleID();
 
         auto hits = track->GetHitsPointer();
         if (!hits->GetHadronicOk()) {
@@ -204,28 +260,25 @@ TRestEvent* TRestGeant4QuenchingProcess::ProcessEvent(TRestEvent* inputEvent) {
                  << endl;
             exit(1);
         }
-        auto& energy = hits->GetEnergyRef();
+        const auto& energy = hits->GetEnergyRef();
         for (int hitIndex = 0; hitIndex < int(hits->GetNumberOfHits()); hitIndex++) {
-            const auto& volumeName = hits->GetVolumeName(hitIndex);
-
-            const string isotopeName = hits->GetHadronicTargetIsotopeName(hitIndex);
-            const int isotopeA = hits->GetHadronicTargetIsotopeA(hitIndex);
-            const int isotopeZ = hits->GetHadronicTargetIsotopeZ(hitIndex);
+            if (energy[hitIndex] <= 0) {
+                continue;
+            }
 
-            double recoilEnergy = hits->GetEnergy(hitIndex);
+            const Int_t volumeID = hits->GetVolumeId(hitIndex);
+            const double recoilEnergy = hits->GetEnergy(hitIndex);
 
             double quenchingFactor = 1.0;
-            if (fVolumes.count(volumeName.Data()) && recoilEnergy > 0 && !isotopeName.empty()) {
-                quenchingFactor = QuenchingFactor(recoilEnergy, isotopeA, isotopeZ);
+            if (volumeID >= 0 && volumeID < numberOfQuenchedVolumeIDs && fQuenchedVolumeIDs[volumeID] &&
+                recoilEnergy > 0 && !hits->GetHadronicTargetIsotopeName(hitIndex).empty()) {
+                quenchingFactor = GetLindhardCoefficients(hits->GetHadronicTargetIsotopeA(hitIndex),
+                                                          hits->GetHadronicTargetIsotopeZ(hitIndex))
+                                      .Evaluate(recoilEnergy);
             }
 
-            const auto processName = hits->GetProcessName(hitIndex);
-
-            if (energy[hitIndex] > 0) {
-                fOutputG4Event->fEnergyInVolumePerParticlePerProcess[volumeName.Data()][particleName.Data()]
-                                                                    [processName.Data()] +=
-                    energy[hitIndex] * quenchingFactor;
-            }
+            fOutputG4Event->AddEnergyDeposit(energy[hitIndex] * quenchingFactor, volumeID, particleID,
+                                             hits->GetProcessId(hitIndex));
         }
     }
 
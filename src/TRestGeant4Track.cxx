@@ -82,9 +82,10 @@ EColor TRestGeant4Track::GetParticleColor() const {
 /// the hits of that specific volume will be counted.
 ///
 size_t TRestGeant4Track::GetNumberOfHits(Int_t volID) const {
+    const TRestGeant4Hits& hits = GetHits();
     size_t numberOfHits = 0;
-    for (unsigned int n = 0; n < fHits.GetNumberOfHits(); n++) {
-        if (volID != -1 && fHits.GetVolumeId(n) != volID) {
+    for (unsigned int n = 0; n < hits.GetNumberOfHits(); n++) {
+        if (volID != -1 && hits.GetVolumeId(n) != volID) {
             continue;
         }
         numberOfHits++;
@@ -98,12 +99,13 @@ size_t TRestGeant4Track::GetNumberOfHits(Int_t volID) const {
 /// the hits of that specific volume will be counted.
 ///
 size_t TRestGeant4Track::GetNumberOfPhysicalHits(Int_t volID) const {
+    const TRestGeant4Hits& hits = GetHits();
     size_t numberOfHits = 0;
-    for (unsigned int n = 0; n < fHits.GetNumberOfHits(); n++) {
-        if (volID != -1 && fHits.GetVolumeId(n) != volID) {
+    for (unsigned int n = 0; n < hits.GetNumberOfHits(); n++) {
+        if (volID != -1 && hits.GetVolumeId(n) != volID) {
             continue;
         }
-        if (fHits.GetEnergy(n) <= 0) {
+        if (hits.GetEnergy(n) <= 0) {
             continue;
         }
         numberOfHits++;
@@ -112,6 +114,7 @@ size_t TRestGeant4Track::GetNumberOfPhysicalHits(Int_t volID) const {
 }
 
 void TRestGeant4Track::PrintTrack(size_t maxHits) const {
+    const TRestGeant4Hits& hits = GetHits();
     cout
         << " * TrackID: " << fTrackID << " - Particle: " << fParticleName << " - ParentID: " << fParentID
         << ""
@@ -137,29 +140,30 @@ void TRestGeant4Track::PrintTrack(size_t maxHits) const {
 
     const TRestGeant4Metadata* metadata = GetGeant4Metadata();
     for (unsigned int i = 0; i < nHits; i++) {
-        TString processName = GetProcessName(fHits.GetHitProcess(i));
+        TString processName = GetProcessName(hits.GetHitProcess(i));
         if (processName.IsNull()) {
             processName =
-                TString(std::to_string(fHits.GetHitProcess(i)));  // in case process name is not found, use ID
+                TString(std::to_string(hits.GetHitProcess(i)));  // in case process name is not found, use ID
         }
 
         TString volumeName = "";
         if (metadata != nullptr) {
-            volumeName = metadata->GetGeant4GeometryInfo().GetVolumeFromID(fHits.GetHitVolume(i));
+            volumeName = metadata->GetGeant4GeometryInfo().GetVolumeFromID(hits.GetHitVolume(i));
         }
         if (volumeName.IsNull()) {
             // in case process name is not found, use ID
-            volumeName = TString(std::to_string(fHits.GetHitVolume(i)));
+            volumeName = TString(std::to_string(hits.GetHitVolume(i)));
         }
-        cout << "      - Hit " << i << " - Energy: " << ToEnergyString(fHits.GetEnergy(i))
+        cout << "      - Hit " << i << " - Energy: " << ToEnergyString(hits.GetEnergy(i))
              << " - Process: " << processName << " - Volume: " << volumeName
-             << " - Position: " << VectorToString(TVector3(fHits.GetX(i), fHits.GetY(i), fHits.GetZ(i)))
-             << " mm - Time: " << ToTimeString(fHits.GetTime(i))
-             << " - KE: " << ToEnergyString(fHits.GetKineticEnergy(i)) << endl;
+             << " - Position: " << VectorToString(TVector3(hits.GetX(i), hits.GetY(i), hits.GetZ(i)))
+             << " mm - Time: " << ToTimeString(hits.GetTime(i))
+             << " - KE: " << ToEnergyString(hits.GetKineticEnergy(i)) << endl;
     }
 }
 
 void TRestGeant4Track::PrintTrackFilterVolumes(const std::set<std::string>& volumeNames) const {
+    const TRestGeant4Hits& hits = GetHits();
     const TRestGeant4Metadata* metadata = GetGeant4Metadata();
     if (metadata == nullptr) {
         return;
@@ -167,10 +171,10 @@ void TRestGeant4Track::PrintTrackFilterVolumes(const std::set<std::string>& volu
     bool skip = true;
     for (unsigned int i = 0; i < GetNumberOfHits(); i++) {
         // check volumeName is in set
-        TString volumeName = metadata->GetGeant4GeometryInfo().GetVolumeFromID(fHits.GetHitVolume(i));
+        TString volumeName = metadata->GetGeant4GeometryInfo().GetVolumeFromID(hits.GetHitVolume(i));
         if (volumeName.IsNull()) {
             // in case process name is not found, use ID
-            volumeName = TString(std::to_string(fHits.GetHitVolume(i)));
+            volumeName = TString(std::to_string(hits.GetHitVolume(i)));
         }
         if (volumeNames.find(volumeName.Data()) != volumeNames.end()) {
             skip = false;
@@ -196,56 +200,105 @@ void TRestGeant4Track::PrintTrackFilterVolumes(const std::set<std::string>& volu
 
     size_t nHits = GetNumberOfHits();
     for (unsigned int i = 0; i < nHits; i++) {
-        TString processName = GetProcessName(fHits.GetHitProcess(i));
+        TString processName = GetProcessName(hits.GetHitProcess(i));
         if (processName.IsNull()) {
             processName =
-                TString(std::to_string(fHits.GetHitProcess(i)));  // in case process name is not found, use ID
+                TString(std::to_string(hits.GetHitProcess(i)));  // in case process name is not found, use ID
         }
 
-        TString volumeName = metadata->GetGeant4GeometryInfo().GetVolumeFromID(fHits.GetHitVolume(i));
+        TString volumeName = metadata->GetGeant4GeometryInfo().GetVolumeFromID(hits.GetHitVolume(i));
         if (volumeName.IsNull()) {
             // in case process name is not found, use ID
-            volumeName = TString(std::to_string(fHits.GetHitVolume(i)));
+            volumeName = TString(std::to_string(hits.GetHitVolume(i)));
         }
         if (volumeNames.find(volumeName.Data()) == volumeNames.end()) {
             continue;
         }
-        cout << "      - Hit " << i << " - Energy: " << ToEnergyString(fHits.GetEnergy(i))
+        cout << "      - Hit " << i << " - Energy: " << ToEnergyString(hits.GetEnergy(i))
              << " - Process: " << processName << " - Volume: " << volumeName
-             << " - Position: " << VectorToString(TVector3(fHits.GetX(i), fHits.GetY(i), fHits.GetZ(i)))
-             << " mm - Time: " << ToTimeString(fHits.GetTime(i))
-             << " - KE: " << ToEnergyString(fHits.GetKineticEnergy(i)) << endl;
+             << " - Position: " << VectorToString(TVector3(hits.GetX(i), hits.GetY(i), hits.GetZ(i)))
+             << " mm - Time: " << ToTimeString(hits.GetTime(i))
+             << " - KE: " << ToEnergyString(hits.GetKineticEnergy(i)) << endl;
     }
 }
 
 Bool_t TRestGeant4Track::ContainsProcessInVolume(Int_t processID, Int_t volumeID) const {
+    const TRestGeant4Hits& hits = GetHits();
     for (unsigned int i = 0; i < GetNumberOfHits(); i++) {
-        if (fHits.GetHitProcess(i) != processID) continue;
-        if (volumeID == -1 || fHits.GetVolumeId(i) == volumeID) return true;
+        if (hits.GetHitProcess(i) != processID) continue;
+        if (volumeID == -1 || hits.GetVolumeId(i) == volumeID) return true;
     }
     return false;
 }
 
 Bool_t TRestGeant4Track::ContainsProcessInVolume(const TString& processName, Int_t volumeID) const {
+    const TRestGeant4Hits& hits = GetHits();
     const TRestGeant4Metadata* metadata = GetGeant4Metadata();
     if (metadata == nullptr) {
         return false;
     }
     const auto& processID = metadata->GetGeant4PhysicsInfo().GetProcessID(processName);
     for (unsigned int i = 0; i < GetNumberOfHits(); i++) {
-        if (fHits.GetHitProcess(i) != processID) continue;
-        if (volumeID == -1 || fHits.GetVolumeId(i) == volumeID) return true;
+        if (hits.GetHitProcess(i) != processID) continue;
+        if (volumeID == -1 || hits.GetVolumeId(i) == volumeID) return true;
     }
     return false;
 }
 
+///////////////////////////////////////////////
+/// \brief Binds the simulation metadata to the track and its hits, and resolves the particle and creator
+/// process IDs, so that they can be compared as integers.
+///
+void TRestGeant4Track::SetGeant4Metadata(const TRestGeant4Metadata* metadata) {
+    fGeant4Metadata = metadata;
+    fHits.SetGeant4Metadata(metadata);
+
+    if (metadata == nullptr) {
+        fParticleID = -1;
+        fCreatorProcessID = -1;
+        return;
+    }
+    fParticleID = metadata->GetGeant4PhysicsInfo().FindParticleID(fParticleName);
+    fCreatorProcessID = metadata->GetGeant4PhysicsInfo().FindProcessID(fCreatorProcess);
+}
+
 const TRestGeant4Metadata* TRestGeant4Track::GetGeant4Metadata() const {
+    if (fGeant4Metadata != nullptr) {
+        // bound by TRestGeant4Event::InitializeReferences
+        return fGeant4Metadata;
+    }
     if (GetEvent() == nullptr) {
         return nullptr;
     }
     return GetEvent()->GetGeant4Metadata();
 }
 
+TRestGeant4Hits* TRestGeant4Track::GetHitsPointer() {
+    if (fHitsPending) {
+        LoadHits();
+    }
+    if (fEvent != nullptr) {
+        fEvent->ClearHitsColumns();
+    }
+    return &fHits;
+}
+
+void TRestGeant4Track::SetHits(const TRestGeant4Hits& hits) {
+    // pending hits are read first, so that a later read does not overwrite the new ones
+    GetHitsPointer();
+    fHits = hits;
+    fHits.SetTrack(this);
+    fHits.SetEvent(fEvent);
+    fHits.SetGeant4Metadata(fGeant4Metadata);
+}
+
+void TRestGeant4Track::LoadHits() const {
+    if (fEvent == nullptr) {
+        return;
+    }
+    fEvent->LoadHits();
+}
+
 TRestGeant4Track* TRestGeant4Track::GetParentTrack() const {
     if (fEvent == nullptr) {
         return nullptr;
@@ -289,12 +342,18 @@ Double_t TRestGeant4Track::GetEnergyInVolume(const TString& volumeName, bool chi
         return 0;
     }
 
-    const auto volumeId = metadata->GetGeant4GeometryInfo().GetIDFromVolume(volumeName);
+    return GetEnergyInVolume(metadata->GetGeant4GeometryInfo().GetIDFromVolume(volumeName), children);
+}
 
+Double_t TRestGeant4Track::GetEnergyInVolume(Int_t volumeId, bool children) const {
     if (!children) {
         return GetEnergyInVolume(volumeId);
     }
 
+    if (fEvent != nullptr && fEvent->GetTrackByID(fTrackID) == this) {
+        return fEvent->GetEnergyInVolumeInSubtree(this - fEvent->GetTracks().data(), volumeId);
+    }
+
     Double_t energy = 0;
     vector<const TRestGeant4Track*> tracks = {this};
     while (!tracks.empty()) {
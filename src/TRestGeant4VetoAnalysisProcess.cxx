@@ -69,6 +69,7 @@
 #include <TObjString.h>
 #include <TString.h>
 
+#include <algorithm>
 #include <iostream>
 #include <unordered_map>
 
@@ -166,7 +167,7 @@ TRestGeant4VetoAnalysisProcess::TRestGeant4VetoAnalysisProcess(const char* confi
     }
 }
 
-TRestGeant4VetoAnalysisProcess::~TRestGeant4VetoAnalysisProcess() { delete fOutputEvent; }
+TRestGeant4VetoAnalysisProcess::~TRestGeant4VetoAnalysisProcess() = default;
 
 ///////////////////////////////////////////////
 /// \brief Function to load the default config in absence of RML input
@@ -181,7 +182,9 @@ void TRestGeant4VetoAnalysisProcess::Initialize() {
     SetSectionName(this->ClassName());
     SetLibraryVersion(LIBRARY_VERSION);
 
-    fOutputEvent = new TRestGeant4Event();
+    // read-only process, the input event is passed through (see ProcessEvent)
+    fInputEvent = nullptr;
+    fOutputEvent = nullptr;
 }
 
 ///////////////////////////////////////////////
@@ -236,88 +239,122 @@ void TRestGeant4VetoAnalysisProcess::InitProcess() {
         }
     }
 
+    BuildVetoTables();
+
+    const auto& physicsInfo = fGeant4Metadata->GetGeant4PhysicsInfo();
+    fNeutronParticleID = physicsInfo.FindParticleID("neutron");
+    fGammaParticleID = physicsInfo.FindParticleID("gamma");
+    fNeutronCaptureProcessID = physicsInfo.FindProcessID("nCapture");
+
     // PrintMetadata();
 }
 
+///////////////////////////////////////////////
+/// \brief It resolves the volume ID, the group, layer and group layer indices and the
+/// observable name of each veto once, so that ProcessEvent accumulates the energies in
+/// flat arrays instead of parsing the veto names on every event.
+///
+void TRestGeant4VetoAnalysisProcess::BuildVetoTables() {
+    const auto& geometryInfo = fGeant4Metadata->GetGeant4GeometryInfo();
+
+    fVetoVolumeIDs.clear();
+    fVetoEnergyObservables.clear();
+    fVetoGroups.clear();
+    fVetoGroupLayers.clear();
+    fVetoLayers.clear();
+    for (const auto& veto : fVetoVolumes) {
+        fVetoVolumeIDs.push_back(geometryInfo.HasVolumeID(veto.name) ? geometryInfo.GetIDFromVolume(veto.name)
+                                                                     : -1);
+        fVetoEnergyObservables.push_back("EnergyVeto_" + veto.alias);
+        fVetoGroups.push_back(veto.group);
+        fVetoGroupLayers.emplace_back(veto.group, veto.layer);
+        fVetoLayers.push_back(veto.layer);
+    }
+
+    // sorted as the keys of a std::map, which keeps the order in which the observables were set
+    sort(fVetoGroups.begin(), fVetoGroups.end());
+    fVetoGroups.erase(unique(fVetoGroups.begin(), fVetoGroups.end()), fVetoGroups.end());
+    sort(fVetoGroupLayers.begin(), fVetoGroupLayers.end());
+    fVetoGroupLayers.erase(unique(fVetoGroupLayers.begin(), fVetoGroupLayers.end()), fVetoGroupLayers.end());
+    sort(fVetoLayers.begin(), fVetoLayers.end());
+    fVetoLayers.erase(unique(fVetoLayers.begin(), fVetoLayers.end()), fVetoLayers.end());
+
+    fVetoGroupIndex.clear();
+    fVetoGroupLayerIndex.clear();
+    fVetoLayerIndex.clear();
+    for (const auto& veto : fVetoVolumes) {
+        fVetoGroupIndex.push_back(lower_bound(fVetoGroups.begin(), fVetoGroups.end(), veto.group) -
+                                  fVetoGroups.begin());
+        fVetoGroupLayerIndex.push_back(lower_bound(fVetoGroupLayers.begin(), fVetoGroupLayers.end(),
+                                                   make_pair(veto.group, veto.layer)) -
+                                       fVetoGroupLayers.begin());
+        fVetoLayerIndex.push_back(lower_bound(fVetoLayers.begin(), fVetoLayers.end(), veto.layer) -
+                                  fVetoLayers.begin());
+    }
+}
+
 ///////////////////////////////////////////////
 /// \brief The main processing event function
 ///
 TRestEvent* TRestGeant4VetoAnalysisProcess::ProcessEvent(TRestEvent* inputEvent) {
     fInputEvent = (TRestGeant4Event*)inputEvent;
-    *fOutputEvent = *((TRestGeant4Event*)inputEvent);
-
-    map<string, double> vetoEnergyMap;
-    map<string, double> vetoGroupEnergyMap;
-    map<pair<string, int>, double> vetoGroupLayerEnergyMap;
+    // the event is not modified, there is no need to copy it
+    fOutputEvent = fInputEvent;
+
+    vector<double> vetoGroupEnergy(fVetoGroups.size(), 0);
+    vector<double> vetoGroupLayerEnergy(fVetoGroupLayers.size(), 0);
+    vector<double> vetoGroupMaxEnergy(fVetoGroups.size(), 0);
+    vector<double> vetoGroupLayerMaxEnergy(fVetoGroupLayers.size(), 0);
+    vector<double> vetoLayerMaxEnergy(fVetoLayers.size(), 0);
     double totalVetoEnergy = 0;
+    double maxEnergy = 0;
 
-    for (const auto& veto : fVetoVolumes) {
-        const double energy = fInputEvent->GetEnergyInVolume(veto.name);
+    for (size_t vetoIndex = 0; vetoIndex < fVetoVolumes.size(); vetoIndex++) {
+        const Int_t volumeID = fVetoVolumeIDs[vetoIndex];
+        const double energy = volumeID >= 0 ? fInputEvent->GetEnergyInVolume(volumeID)
+                                            : fInputEvent->GetEnergyInVolume(fVetoVolumes[vetoIndex].name);
+
+        const size_t groupIndex = fVetoGroupIndex[vetoIndex];
+        const size_t groupLayerIndex = fVetoGroupLayerIndex[vetoIndex];
+        const size_t layerIndex = fVetoLayerIndex[vetoIndex];
 
         totalVetoEnergy += energy;
-        vetoEnergyMap[veto.name] = energy;
-        vetoGroupEnergyMap[veto.group] += energy;
-        vetoGroupLayerEnergyMap[make_pair(veto.group, veto.layer)] += energy;
+        vetoGroupEnergy[groupIndex] += energy;
+        vetoGroupLayerEnergy[groupLayerIndex] += energy;
 
-        SetObservableValue("EnergyVeto_" + veto.alias, energy);
+        maxEnergy = max(maxEnergy, energy);
+        vetoGroupMaxEnergy[groupIndex] = max(vetoGroupMaxEnergy[groupIndex], energy);
+        vetoGroupLayerMaxEnergy[groupLayerIndex] = max(vetoGroupLayerMaxEnergy[groupLayerIndex], energy);
+        vetoLayerMaxEnergy[layerIndex] = max(vetoLayerMaxEnergy[layerIndex], energy);
+
+        SetObservableValue(fVetoEnergyObservables[vetoIndex], energy);
     }
 
-    for (const auto& [group, energy] : vetoGroupEnergyMap) {
-        SetObservableValue("EnergyGroup_" + group, energy);
+    for (size_t n = 0; n < fVetoGroups.size(); n++) {
+        SetObservableValue("EnergyGroup_" + fVetoGroups[n], vetoGroupEnergy[n]);
     }
 
-    for (const auto& [groupLayer, energy] : vetoGroupLayerEnergyMap) {
-        SetObservableValue("EnergyGroupLayer_" + groupLayer.first + "_" + to_string(groupLayer.second),
-                           energy);
+    for (size_t n = 0; n < fVetoGroupLayers.size(); n++) {
+        const auto& [group, layer] = fVetoGroupLayers[n];
+        SetObservableValue("EnergyGroupLayer_" + group + "_" + to_string(layer), vetoGroupLayerEnergy[n]);
     }
 
     SetObservableValue("EnergyTotal", totalVetoEnergy);
 
-    // compute max energy
-    double maxEnergy = 0;
-    for (const auto& [name, energy] : vetoEnergyMap) {
-        if (energy > maxEnergy) {
-            maxEnergy = energy;
-        }
-    }
     SetObservableValue("EnergyMax", maxEnergy);
 
-    // compute max energy for each group
-    map<string, double> vetoGroupMaxEnergyMap;
-    for (const auto& [name, energy] : vetoEnergyMap) {
-        const auto veto = GetVetoFromString(name);
-        if (vetoGroupMaxEnergyMap[veto.group] < energy) {
-            vetoGroupMaxEnergyMap[veto.group] = energy;
-        }
-    }
-    for (const auto& [group, energy] : vetoGroupMaxEnergyMap) {
-        SetObservableValue("EnergyGroupMax_" + group, energy);
+    for (size_t n = 0; n < fVetoGroups.size(); n++) {
+        SetObservableValue("EnergyGroupMax_" + fVetoGroups[n], vetoGroupMaxEnergy[n]);
     }
 
-    // compute max energy for each group layer
-    map<pair<string, int>, double> vetoGroupLayerMaxEnergyMap;
-    for (const auto& [name, energy] : vetoEnergyMap) {
-        const auto veto = GetVetoFromString(name);
-        if (vetoGroupLayerMaxEnergyMap[make_pair(veto.group, veto.layer)] < energy) {
-            vetoGroupLayerMaxEnergyMap[make_pair(veto.group, veto.layer)] = energy;
-        }
+    for (size_t n = 0; n < fVetoGroupLayers.size(); n++) {
+        const auto& [group, layer] = fVetoGroupLayers[n];
+        SetObservableValue("EnergyGroupLayerMax_" + group + "_" + to_string(layer),
+                           vetoGroupLayerMaxEnergy[n]);
     }
 
-    for (const auto& [groupLayer, energy] : vetoGroupLayerMaxEnergyMap) {
-        SetObservableValue("EnergyGroupLayerMax_" + groupLayer.first + "_" + to_string(groupLayer.second),
-                           energy);
-    }
-
-    // compute max energy for each layer (all groups)
-    map<int, double> vetoLayerMaxEnergyMap;
-    for (const auto& [name, energy] : vetoEnergyMap) {
-        const auto veto = GetVetoFromString(name);
-        if (vetoLayerMaxEnergyMap[veto.layer] < energy) {
-            vetoLayerMaxEnergyMap[veto.layer] = energy;
-        }
-    }
-    for (const auto& [layer, energy] : vetoLayerMaxEnergyMap) {
-        SetObservableValue("EnergyLayerMax_" + to_string(layer), energy);
+    for (size_t n = 0; n < fVetoLayers.size(); n++) {
+        SetObservableValue("EnergyLayerMax_" + to_string(fVetoLayers[n]), vetoLayerMaxEnergy[n]);
     }
 
     // compute neutron capture observables
@@ -337,57 +374,54 @@ TRestEvent* TRestGeant4VetoAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
     vector<float> nCapturesInCaptureVolumesPositionY;
     vector<float> nCapturesInCaptureVolumesPositionZ;
 
-    for (const auto& track : fInputEvent->GetTracks()) {
-        if (track.GetParticleName() == "neutron") {
-            const auto hits = track.GetHits();
-            for (size_t hitIndex = 0; hitIndex < hits.GetNumberOfHits(); hitIndex++) {
-                const auto processName = hits.GetProcessName(hitIndex);
-                if (processName != "nCapture") {
+    // only the neutron capture hits are visited, through the per-event process index
+    for (const auto& [trackIndex, hitIndex] : fInputEvent->GetProcessOccurrences(fNeutronCaptureProcessID)) {
+        const auto& track = fInputEvent->GetTrack(trackIndex);
+        if (!track.IsParticle(fNeutronParticleID, "neutron")) {
+            continue;
+        }
+        const auto& hits = track.GetHits();
+        nCaptures++;
+        const string volumeName = hits.GetVolumeName(hitIndex).Data();
+        const double time = hits.GetTime(hitIndex);
+
+        if (volumeName.find("captureLayerVolume") != string::npos) {
+            nCapturesInCaptureVolumes++;
+            nCapturesInCaptureVolumesNeutronTrackIds.insert(track.GetTrackID());
+            nCapturesInCaptureVolumesTimes.push_back(time);
+            const TVector3& position = hits.GetPosition(hitIndex);
+            nCapturesInCaptureVolumesPositionX.push_back(position.X());
+            nCapturesInCaptureVolumesPositionY.push_back(position.Y());
+            nCapturesInCaptureVolumesPositionZ.push_back(position.Z());
+            vector<float> childrenEnergy;
+            const auto children = track.GetChildrenTracks();
+            for (const auto& child : children) {
+                if (!child->IsParticle(fGammaParticleID, "gamma")) {
+                    continue;
+                }
+                if (!child->IsCreatorProcess(fNeutronCaptureProcessID, "nCapture")) {
                     continue;
                 }
-                nCaptures++;
-                const string volumeName = hits.GetVolumeName(hitIndex).Data();
-                const double time = hits.GetTime(hitIndex);
-
-                if (volumeName.find("captureLayerVolume") != string::npos) {
-                    nCapturesInCaptureVolumes++;
-                    nCapturesInCaptureVolumesNeutronTrackIds.insert(track.GetTrackID());
-                    nCapturesInCaptureVolumesTimes.push_back(time);
-                    const TVector3& position = hits.GetPosition(hitIndex);
-                    nCapturesInCaptureVolumesPositionX.push_back(position.X());
-                    nCapturesInCaptureVolumesPositionY.push_back(position.Y());
-                    nCapturesInCaptureVolumesPositionZ.push_back(position.Z());
-                    vector<float> childrenEnergy;
-                    const auto children = track.GetChildrenTracks();
-                    for (const auto& child : children) {
-                        if (child->GetParticleName() != "gamma") {
-                            continue;
-                        }
-                        if (child->GetCreatorProcess() != "nCapture") {
-                            continue;
-                        }
-                        childrenEnergy.push_back(child->GetInitialKineticEnergy());
-                        double energyInVeto = 0;
-                        for (const auto& veto : fVetoVolumes) {
-                            energyInVeto += child->GetEnergyInVolume(veto.name, true);
-                        }
-                        nCapturesInCaptureVolumesChildGammasEnergyInVetos.push_back(energyInVeto);
-                    }
-                    nCapturesInCaptureVolumesChildGammaEnergies.push_back(childrenEnergy);
-
-                    vector<float> energyInVetoesForCapture;
-                    for (const auto& veto : fVetoVolumes) {
-                        const double energyInVeto = track.GetEnergyInVolume(veto.name, true);
-                        if (energyInVeto > 0) {  // soft limit of 100 keV
-                            energyInVetoesForCapture.push_back(energyInVeto);
-                        }
-                    }
-                    nCapturesInCaptureVolumesEnergyInVetoesForCapture.push_back(energyInVetoesForCapture);
+                childrenEnergy.push_back(child->GetInitialKineticEnergy());
+                double energyInVeto = 0;
+                for (const auto volumeID : fVetoVolumeIDs) {
+                    energyInVeto += child->GetEnergyInVolume(volumeID, true);
                 }
-                if (volumeName.find("scintillatorVolume") != string::npos) {
-                    nCapturesInVetoVolumes++;
+                nCapturesInCaptureVolumesChildGammasEnergyInVetos.push_back(energyInVeto);
+            }
+            nCapturesInCaptureVolumesChildGammaEnergies.push_back(childrenEnergy);
+
+            vector<float> energyInVetoesForCapture;
+            for (const auto volumeID : fVetoVolumeIDs) {
+                const double energyInVeto = track.GetEnergyInVolume(volumeID, true);
+                if (energyInVeto > 0) {  // soft limit of 100 keV
+                    energyInVetoesForCapture.push_back(energyInVeto);
                 }
             }
+            nCapturesInCaptureVolumesEnergyInVetoesForCapture.push_back(energyInVetoesForCapture);
+        }
+        if (volumeName.find("scintillatorVolume") != string::npos) {
+            nCapturesInVetoVolumes++;
         }
     }
 
@@ -405,7 +439,7 @@ TRestEvent* TRestGeant4VetoAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
                                                              // neutron (primary neutron has generation 0)
     for (const auto& neutronCaptureTrackId : nCapturesInCaptureVolumesNeutronTrackIds) {
         auto track = fInputEvent->GetTrackByID(neutronCaptureTrackId);
-        if (track->GetParticleName() != "neutron") {
+        if (!track->IsParticle(fNeutronParticleID, "neutron")) {
             cerr << "TRestGeant4VetoAnalysisProcess::ProcessEvent: track is not a neutron" << endl;
             exit(1);
         }
@@ -415,7 +449,7 @@ TRestEvent* TRestGeant4VetoAnalysisProcess::ProcessEvent(TRestEvent* inputEvent)
 
         while (track->GetParentTrack() != nullptr) {
             track = track->GetParentTrack();
-            if (track->GetParticleName() == "neutron") {
+            if (track->IsParticle(fNeutronParticleID, "neutron")) {
                 generation++;
             }
         }
@@ -1,15 +1,23 @@
 
+#include <TRestGeant4AnalysisProcess.h>
+#include <TRestGeant4BlobAnalysisProcess.h>
 #include <TRestGeant4VetoAnalysisProcess.h>
 #include <gtest/gtest.h>
 
+#include <cmath>
 #include <filesystem>
 
+#include "Geant4TestEvents.h"
+
 namespace fs = std::filesystem;
 
 using namespace std;
+using namespace Geant4TestEvents;
 
 const auto filesPath = fs::path(__FILE__).parent_path().parent_path() / "files";
 const auto processRmlFile = filesPath / "TRestGeant4VetoAnalysisProcessExample.rml";
+const auto blobAnalysisProcessRmlFile = filesPath / "TRestGeant4BlobAnalysisProcessExample.rml";
+const auto analysisProcessRmlFile = filesPath / "TRestGeant4AnalysisProcessExample.rml";
 const auto simulationFile = filesPath / "VetoAnalysisGeant4Run.root";
 
 TEST(TRestGeant4VetoAnalysisProcess, TestFiles) {
@@ -63,3 +71,151 @@ TEST(TRestGeant4VetoAnalysisProcess, Simulation) {
 
     process.PrintMetadata();
 }
+
+TEST(TRestGeant4AnalysisProcess, Observables) {
+    // the expected values are computed by hand from the events of Geant4TestEvents.h
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestRun run;
+    run.AddMetadata(&metadata);
+
+    TRestGeant4AnalysisProcess process(analysisProcessRmlFile.c_str());
+    EXPECT_EQ(string(process.GetName()), "g4Ana");
+
+    TRestAnalysisTree analysisTree;
+    process.SetRunInfo(&run);
+    process.SetAnalysisTree(&analysisTree);
+    process.InitProcess();
+
+    const auto value = [&analysisTree](const string& name) {
+        return analysisTree.GetObservableValue<Double_t>("g4Ana_" + name);
+    };
+    const auto count = [&analysisTree](const string& name) {
+        return analysisTree.GetObservableValue<Int_t>("g4Ana_" + name);
+    };
+    const auto text = [&analysisTree](const string& name) {
+        return analysisTree.GetObservableValue<string>("g4Ana_" + name);
+    };
+
+    TRestGeant4Event event;
+
+    FillEvent(event, &metadata, 0);
+    EXPECT_EQ(process.ProcessEvent(&event), &event);
+
+    EXPECT_DOUBLE_EQ(value("gasVolumeVolumeEDep"), 732);
+    EXPECT_DOUBLE_EQ(value("vesselVolumeVolumeEDep"), 50);
+    EXPECT_DOUBLE_EQ(value("sensitiveVolumeEnergy"), 732);
+    EXPECT_DOUBLE_EQ(value("totalEdep"), 792);
+
+    EXPECT_DOUBLE_EQ(value("gasVolumeMeanPosX"), 2540. / 732);
+    EXPECT_DOUBLE_EQ(value("gasVolumeMeanPosY"), 660. / 732);
+    EXPECT_DOUBLE_EQ(value("gasVolumeMeanPosZ"), 990. / 732);
+    // the hit of the primary gamma in the vessel has no energy
+    EXPECT_DOUBLE_EQ(value("vesselVolumeMeanPosX"), 12);
+
+    EXPECT_EQ(count("gammaTracksCounter"), 2);
+    EXPECT_EQ(count("e-TracksCounter"), 2);
+    EXPECT_EQ(count("neutronTracksCounter"), 0);
+    EXPECT_DOUBLE_EQ(value("gammaTracksEDep"), 42);
+    EXPECT_DOUBLE_EQ(value("e-TracksEDep"), 750);
+    EXPECT_DOUBLE_EQ(value("neutronTracksEDep"), 0);
+
+    EXPECT_EQ(count("containsProcessPhot"), 1);
+    EXPECT_EQ(count("containsProcessCompt"), 1);
+
+    EXPECT_DOUBLE_EQ(value("sensitiveVolumeFirstHitTime"), 2);
+    EXPECT_DOUBLE_EQ(value("firstTrackInSensitivePositionX"), 0);
+    EXPECT_DOUBLE_EQ(value("firstTrackInSensitivePositionY"), 0);
+    EXPECT_DOUBLE_EQ(value("firstTrackInSensitivePositionZ"), -100);
+    EXPECT_DOUBLE_EQ(value("firstTrackInSensitiveEnergy"), 1000);
+    EXPECT_EQ(text("firstTrackInSensitiveParticle"), "gamma");
+    EXPECT_EQ(text("firstTrackInSensitiveParentParticle"), "");
+    EXPECT_EQ(text("firstTrackInSensitiveCreatorProcess"), "");
+    EXPECT_EQ(text("firstTrackInSensitiveVolumeName"), "shieldingVolume");
+    EXPECT_TRUE(analysisTree.GetObservableValue<bool>("g4Ana_firstTrackInSensitiveOk"));
+
+    EXPECT_DOUBLE_EQ(value("energyPrimary"), 1000);
+    EXPECT_DOUBLE_EQ(value("zOriginPrimary"), -100);
+    EXPECT_EQ(text("eventPrimaryParticleName"), "gamma");
+    EXPECT_DOUBLE_EQ(value("boundingSize"), TMath::Sqrt(374));
+
+    FillEvent(event, &metadata, 1);
+    EXPECT_EQ(process.ProcessEvent(&event), &event);
+
+    EXPECT_DOUBLE_EQ(value("gasVolumeVolumeEDep"), 150);
+    EXPECT_DOUBLE_EQ(value("vesselVolumeVolumeEDep"), 0);
+    EXPECT_DOUBLE_EQ(value("totalEdep"), 150.5);
+
+    EXPECT_DOUBLE_EQ(value("gasVolumeMeanPosX"), 0);
+    EXPECT_DOUBLE_EQ(value("gasVolumeMeanPosY"), 1);
+    EXPECT_DOUBLE_EQ(value("gasVolumeMeanPosZ"), 1);
+    // no energy in the vessel
+    EXPECT_TRUE(std::isnan(value("vesselVolumeMeanPosX")));
+
+    EXPECT_EQ(count("gammaTracksCounter"), 1);
+    EXPECT_EQ(count("e-TracksCounter"), 1);
+    EXPECT_EQ(count("neutronTracksCounter"), 1);
+    EXPECT_DOUBLE_EQ(value("gammaTracksEDep"), 5);
+    EXPECT_DOUBLE_EQ(value("e-TracksEDep"), 145);
+    EXPECT_DOUBLE_EQ(value("neutronTracksEDep"), 0.5);
+
+    EXPECT_EQ(count("containsProcessPhot"), 0);
+    EXPECT_EQ(count("containsProcessCompt"), 1);
+
+    // the gamma enters the gas at 10.1 without depositing energy, hit times are stored as floats
+    EXPECT_FLOAT_EQ(value("sensitiveVolumeFirstHitTime"), 10.2);
+    EXPECT_DOUBLE_EQ(value("firstTrackInSensitivePositionZ"), -200);
+    EXPECT_DOUBLE_EQ(value("firstTrackInSensitiveEnergy"), 1);
+    EXPECT_EQ(text("firstTrackInSensitiveParticle"), "neutron");
+    EXPECT_EQ(text("firstTrackInSensitiveVolumeName"), "shieldingVolume");
+    EXPECT_TRUE(analysisTree.GetObservableValue<bool>("g4Ana_firstTrackInSensitiveOk"));
+
+    EXPECT_DOUBLE_EQ(value("energyPrimary"), 1);
+    EXPECT_EQ(text("eventPrimaryParticleName"), "neutron");
+}
+
+TEST(TRestGeant4BlobAnalysisProcess, Clusters) {
+    TRestGeant4BlobAnalysisProcess process(blobAnalysisProcessRmlFile.c_str());
+
+    TRestAnalysisTree analysisTree;
+    process.SetAnalysisTree(&analysisTree);
+    process.InitProcess();
+
+    // hits at the centre of 1 mm voxels along x. The voxels x = 0 and x = 2 are the densest of their
+    // neighbourhoods, and share the voxel x = 1. A far deposit makes a second cluster, and a hit beyond
+    // the range of an Int_t voxel index a third one. The hit at 1e30 mm is out of the voxel grid.
+    TRestGeant4Track track;
+    const vector<pair<Double_t, Double_t>> hits = {{-0.5, 150}, {0.5, 100}, {1.5, 1},  {2.5, 100},
+                                                   {3.5, 150},  {100.5, 20}, {3e9, 7}, {1e30, 5}};
+    for (const auto& [x, energy] : hits) {
+        track.GetHitsPointer()->AddG4Hit({x, 0.5, 0.5}, energy, 0, 0, 0);
+    }
+    TRestGeant4Event event;
+    event.AddTrack(track);
+
+    Int_t numberOfClusters = 0;
+    const auto blobs = process.FindBlobs(event, numberOfClusters);
+    EXPECT_EQ(numberOfClusters, 3);
+    ASSERT_EQ(blobs.size(), 3);
+
+    // the shared voxel is only in the first blob
+    EXPECT_DOUBLE_EQ(blobs[0].energy, 251);
+    EXPECT_DOUBLE_EQ(blobs[0].position.X(), -23.5 / 251);
+    EXPECT_DOUBLE_EQ(blobs[0].position.Y(), 0.5);
+    EXPECT_DOUBLE_EQ(blobs[1].energy, 250);
+    EXPECT_DOUBLE_EQ(blobs[1].position.X(), 3.1);
+    EXPECT_NEAR(blobs[1].extent, TMath::Sqrt(0.24), 1e-12);
+    EXPECT_EQ(blobs[0].cluster, blobs[1].cluster);
+    EXPECT_DOUBLE_EQ(blobs[2].energy, 20);
+    EXPECT_DOUBLE_EQ(blobs[2].position.X(), 100.5);
+    EXPECT_DOUBLE_EQ(blobs[2].extent, 0);
+    EXPECT_NE(blobs[2].cluster, blobs[0].cluster);
+
+    EXPECT_EQ(process.ProcessEvent(&event), &event);
+    EXPECT_EQ(analysisTree.GetObservableValue<Int_t>("g4Blob_nBlobs"), 3);
+    EXPECT_EQ(analysisTree.GetObservableValue<Int_t>("g4Blob_nClusters"), 3);
+    EXPECT_DOUBLE_EQ(analysisTree.GetObservableValue<Double_t>("g4Blob_blob1_energy"), 251);
+    EXPECT_DOUBLE_EQ(analysisTree.GetObservableValue<Double_t>("g4Blob_blob2_energy"), 250);
+    EXPECT_DOUBLE_EQ(analysisTree.GetObservableValue<Double_t>("g4Blob_blob3_energy"), 20);
+}
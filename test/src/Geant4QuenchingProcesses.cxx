@@ -61,3 +61,22 @@ TEST(TRestGeant4QuenchingProcess, Simulation) {
 
     EXPECT_TRUE(process.GetUserVolumeExpressions().size() == 2);
 }
+
+TEST(TRestGeant4QuenchingProcess, LindhardQuenchingFactor) {
+    // reference implementation of the Lindhard formula
+    const auto lindhard = [](double recoilEnergy, int A, int Z) {
+        double gamma = 11.5 * recoilEnergy * TMath::Power(Z, -7.0 / 3.0);
+        double g = 3 * TMath::Power(gamma, 0.15) + 0.7 * TMath::Power(gamma, 0.6) + gamma;
+        double k = 0.133 * TMath::Power(Z, 2.0 / 3.0) * TMath::Power(A, -1.0 / 2.0);
+        return k * g / (1 + k * g);
+    };
+
+    const vector<pair<int, int>> isotopes = {{1, 1}, {12, 6}, {40, 18}, {132, 54}};
+    for (const auto& [A, Z] : isotopes) {
+        for (const double recoilEnergy : {0.01, 0.5, 1.0, 10.0, 250.0, 5000.0}) {
+            const double expected = lindhard(recoilEnergy, A, Z);
+            EXPECT_NEAR(TRestGeant4QuenchingProcess::LindhardQuenchingFactor(recoilEnergy, A, Z), expected,
+                        1E-12 * expected);
+        }
+    }
+}
@@ -0,0 +1,202 @@
+// Simulation metadata and events with known contents, built in memory (or written to a run file) for the
+// tests which need simulated data. The expected values in the tests are computed by hand from these events.
+
+#ifndef REST_Geant4TestEvents
+#define REST_Geant4TestEvents
+
+#include <TRestGeant4Event.h>
+#include <TRestGeant4Metadata.h>
+#include <TRestGeant4ParticleSource.h>
+#include <TRestRun.h>
+
+#include <string>
+
+namespace Geant4TestEvents {
+
+// volume IDs, the first two are also the active volumes, in the same order
+constexpr Int_t gasVolumeID = 0;
+constexpr Int_t vesselVolumeID = 1;
+constexpr Int_t shieldingVolumeID = 2;
+
+constexpr Int_t gammaID = 0;
+constexpr Int_t electronID = 1;
+constexpr Int_t neutronID = 2;
+constexpr Int_t alphaID = 3;
+
+constexpr Int_t initProcessID = 0;
+constexpr Int_t transportationProcessID = 1;
+constexpr Int_t eIoniProcessID = 2;
+constexpr Int_t eBremProcessID = 3;
+constexpr Int_t photProcessID = 12;
+constexpr Int_t comptProcessID = 13;
+constexpr Int_t nCaptureProcessID = 131;
+
+constexpr Int_t numberOfEvents = 2;
+
+inline void FillMetadata(TRestGeant4Metadata& metadata) {
+    // restG4 fills the geometry and physics info while simulating, there are no setters for the analysis
+    auto& geometryInfo = const_cast<TRestGeant4GeometryInfo&>(metadata.GetGeant4GeometryInfo());
+    geometryInfo.InsertVolumeName(gasVolumeID, "gasVolume");
+    geometryInfo.InsertVolumeName(vesselVolumeID, "vesselVolume");
+    geometryInfo.InsertVolumeName(shieldingVolumeID, "shieldingVolume");
+
+    auto& physicsInfo = const_cast<TRestGeant4PhysicsInfo&>(metadata.GetGeant4PhysicsInfo());
+    physicsInfo.InsertParticleName(gammaID, "gamma");
+    physicsInfo.InsertParticleName(electronID, "e-");
+    physicsInfo.InsertParticleName(neutronID, "neutron");
+    physicsInfo.InsertParticleName(alphaID, "alpha");
+
+    physicsInfo.InsertProcessName(initProcessID, "Init", "Init");
+    physicsInfo.InsertProcessName(transportationProcessID, "Transportation", "Transportation");
+    physicsInfo.InsertProcessName(eIoniProcessID, "eIoni", "Electromagnetic");
+    physicsInfo.InsertProcessName(eBremProcessID, "eBrem", "Electromagnetic");
+    physicsInfo.InsertProcessName(photProcessID, "phot", "Electromagnetic");
+    physicsInfo.InsertProcessName(comptProcessID, "compt", "Electromagnetic");
+    physicsInfo.InsertProcessName(nCaptureProcessID, "nCapture", "Hadronic");
+
+    metadata.SetActiveVolume("gasVolume", 1);
+    metadata.SetActiveVolume("vesselVolume", 1);
+    metadata.InsertSensitiveVolume("gasVolume");
+
+    auto source = new TRestGeant4ParticleSource();
+    source->SetParticleName("gamma");
+    source->SetEnergy(1000);
+    source->SetDirection({0, 0, 1});
+    metadata.AddParticleSource(source);
+}
+
+inline TRestGeant4Track MakeTrack(Int_t trackID, Int_t parentID, const TString& particleName,
+                                  const TString& creatorProcess, Double_t energy, const TVector3& position,
+                                  Double_t time) {
+    TRestGeant4Track track;
+    track.SetTrackID(trackID);
+    track.SetParentID(parentID);
+    track.SetParticleName(particleName);
+    track.SetCreatorProcess(creatorProcess);
+    track.SetInitialKineticEnergy(energy);
+    track.SetInitialPosition(position);
+    track.SetGlobalTime(time);
+    return track;
+}
+
+///////////////////////////////////////////////
+/// Event 0: a 1000 keV gamma entering the gas through the vessel, with a Compton electron and a photo
+/// electron. The photo electron leaves the gas and emits a bremsstrahlung gamma absorbed in the shielding.
+///
+/// track  particle  parent  hits (position mm, energy keV, time, process, volume)
+///   1    gamma       0     (0,0,-50) 0 t=0 Init shielding, (0,0,-10) 0 t=1 Transportation vessel,
+///                          (1,2,3) 30 t=2 compt gas, (5,0,0) 2 t=3 phot gas
+///   2    e-          1     (1,2,3) 100 t=2.5 eIoni gas, (2,2,3) 200 t=2.6 eIoni gas
+///   3    e-          1     (5,0,0) 400 t=3.5 eIoni gas, (12,0,0) 50 t=3.7 eIoni vessel
+///   5    gamma       3     (20,0,0) 10 t=4 compt shielding
+///
+/// Energy in gas 732, vessel 50 and shielding 10 (total 792).
+///
+/// Event 1: a neutron captured in the shielding, and the capture gamma reaching the gas.
+///
+///   1    neutron     0     (0,0,-150) 0 t=0 Init shielding, (0,0,-120) 0.5 t=10 nCapture shielding
+///   2    gamma       1     (0,0,-2) 0 t=10.1 Transportation gas, (0,1,1) 5 t=10.2 compt gas
+///   3    e-          2     (0,1,1) 145 t=10.3 eIoni gas
+///
+/// Energy in gas 150 and shielding 0.5 (total 150.5).
+///
+inline void FillEvent(TRestGeant4Event& event, const TRestGeant4Metadata* metadata, Int_t eventID = 0) {
+    event.Initialize();
+    event.SetID(eventID);
+    event.SetGeant4Metadata(metadata);
+
+    if (eventID == 0) {
+        event.SetPrimaryEventOrigin({0, 0, -100});
+        event.AddPrimaryParticle("gamma", 1000, {0, 0, 1});
+
+        auto track = MakeTrack(1, 0, "gamma", "", 1000, {0, 0, -100}, 0);
+        auto hits = track.GetHitsPointer();
+        hits->AddG4Hit({0, 0, -50}, 0, 0, initProcessID, shieldingVolumeID);
+        hits->AddG4Hit({0, 0, -10}, 0, 1, transportationProcessID, vesselVolumeID);
+        hits->AddG4Hit({1, 2, 3}, 30, 2, comptProcessID, gasVolumeID);
+        hits->AddG4Hit({5, 0, 0}, 2, 3, photProcessID, gasVolumeID);
+        track.AddSecondaryTrackID(2);
+        track.AddSecondaryTrackID(3);
+        event.AddTrack(track);
+
+        track = MakeTrack(2, 1, "e-", "compt", 300, {1, 2, 3}, 2);
+        hits = track.GetHitsPointer();
+        hits->AddG4Hit({1, 2, 3}, 100, 2.5, eIoniProcessID, gasVolumeID);
+        hits->AddG4Hit({2, 2, 3}, 200, 2.6, eIoniProcessID, gasVolumeID);
+        event.AddTrack(track);
+
+        track = MakeTrack(3, 1, "e-", "phot", 460, {5, 0, 0}, 3);
+        hits = track.GetHitsPointer();
+        hits->AddG4Hit({5, 0, 0}, 400, 3.5, eIoniProcessID, gasVolumeID);
+        hits->AddG4Hit({12, 0, 0}, 50, 3.7, eIoniProcessID, vesselVolumeID);
+        track.AddSecondaryTrackID(5);
+        event.AddTrack(track);
+
+        track = MakeTrack(5, 3, "gamma", "eBrem", 10, {12, 0, 0}, 3.7);
+        track.GetHitsPointer()->AddG4Hit({20, 0, 0}, 10, 4, comptProcessID, shieldingVolumeID);
+        event.AddTrack(track);
+
+        event.AddEnergyInVolumeForParticleForProcess(30, gasVolumeID, gammaID, comptProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(2, gasVolumeID, gammaID, photProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(300, gasVolumeID, electronID, eIoniProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(400, gasVolumeID, electronID, eIoniProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(50, vesselVolumeID, electronID, eIoniProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(10, shieldingVolumeID, gammaID, comptProcessID);
+        event.SetSensitiveVolumeEnergy(732);
+    } else {
+        event.SetPrimaryEventOrigin({0, 0, -200});
+        event.AddPrimaryParticle("neutron", 1, {0, 0, 1});
+
+        auto track = MakeTrack(1, 0, "neutron", "", 1, {0, 0, -200}, 0);
+        auto hits = track.GetHitsPointer();
+        hits->AddG4Hit({0, 0, -150}, 0, 0, initProcessID, shieldingVolumeID);
+        hits->AddG4Hit({0, 0, -120}, 0.5, 10, nCaptureProcessID, shieldingVolumeID);
+        track.AddSecondaryTrackID(2);
+        event.AddTrack(track);
+
+        track = MakeTrack(2, 1, "gamma", "nCapture", 2000, {0, 0, -120}, 10);
+        hits = track.GetHitsPointer();
+        hits->AddG4Hit({0, 0, -2}, 0, 10.1, transportationProcessID, gasVolumeID);
+        hits->AddG4Hit({0, 1, 1}, 5, 10.2, comptProcessID, gasVolumeID);
+        track.AddSecondaryTrackID(3);
+        event.AddTrack(track);
+
+        track = MakeTrack(3, 2, "e-", "compt", 145, {0, 1, 1}, 10.2);
+        track.GetHitsPointer()->AddG4Hit({0, 1, 1}, 145, 10.3, eIoniProcessID, gasVolumeID);
+        event.AddTrack(track);
+
+        event.AddEnergyInVolumeForParticleForProcess(0.5, shieldingVolumeID, neutronID, nCaptureProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(5, gasVolumeID, gammaID, comptProcessID);
+        event.AddEnergyInVolumeForParticleForProcess(145, gasVolumeID, electronID, eIoniProcessID);
+        event.SetSensitiveVolumeEnergy(150);
+    }
+}
+
+///////////////////////////////////////////////
+/// Writes a run file with the metadata of FillMetadata and the events of FillEvent, with the event branch
+/// split as restG4 writes it.
+///
+inline void WriteRun(const std::string& filename) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestRun run;
+    run.SetOutputFileName(filename);
+    run.AddMetadata(&metadata);
+    run.FormOutputFile();
+
+    TRestGeant4Event event;
+    run.AddEventBranch(&event);
+    for (Int_t eventID = 0; eventID < numberOfEvents; eventID++) {
+        FillEvent(event, &metadata, eventID);
+        run.GetAnalysisTree()->SetEventInfo(&event);
+        run.GetEventTree()->Fill();
+        run.GetAnalysisTree()->Fill();
+    }
+    run.UpdateOutputFile();
+    run.CloseFile();
+}
+
+}  // namespace Geant4TestEvents
+
+#endif
@@ -0,0 +1,555 @@
+#include <TRestGeant4Event.h>
+#include <TRestGeant4Metadata.h>
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "Geant4TestEvents.h"
+
+namespace fs = std::filesystem;
+
+using namespace std;
+using namespace Geant4TestEvents;
+
+const auto runFile = fs::temp_directory_path() / "TRestGeant4EventTest.root";
+
+namespace {
+void ExpectSameHits(const TRestHits& hits, const TRestHits& expected) {
+    ASSERT_EQ(hits.GetNumberOfHits(), expected.GetNumberOfHits());
+    for (size_t n = 0; n < expected.GetNumberOfHits(); n++) {
+        EXPECT_EQ(hits.GetX(n), expected.GetX(n));
+        EXPECT_EQ(hits.GetY(n), expected.GetY(n));
+        EXPECT_EQ(hits.GetZ(n), expected.GetZ(n));
+        EXPECT_EQ(hits.GetEnergy(n), expected.GetEnergy(n));
+    }
+}
+}  // namespace
+
+TEST(TRestGeant4Event, HitsColumns) {
+    // the event-wide queries must give the same results with and without the columns
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    for (Int_t eventID = 0; eventID < numberOfEvents; eventID++) {
+        TRestGeant4Event event;
+        FillEvent(event, &metadata, eventID);
+        EXPECT_FALSE(event.HasHitsColumns());
+
+        const TRestHits hits = event.GetHits();
+        const TRestHits gasHits = event.GetHits(gasVolumeID);
+        const size_t numberOfHits = event.GetNumberOfHits();
+        const size_t numberOfGasHits = event.GetNumberOfHits(gasVolumeID);
+        const size_t numberOfPhysicalHits = event.GetNumberOfPhysicalHits();
+        const Double_t boundingBoxSize = event.GetBoundingBoxSize();
+        const auto timeRange = event.GetTimeRangeOfIonizationInVolume("gasVolume");
+
+        event.BuildHitsColumns();
+        ASSERT_TRUE(event.HasHitsColumns());
+
+        ExpectSameHits(event.GetHits(), hits);
+        ExpectSameHits(event.GetHits(gasVolumeID), gasHits);
+        EXPECT_EQ(event.GetNumberOfHits(), numberOfHits);
+        EXPECT_EQ(event.GetNumberOfHits(gasVolumeID), numberOfGasHits);
+        EXPECT_EQ(event.GetNumberOfPhysicalHits(), numberOfPhysicalHits);
+        EXPECT_EQ(event.GetBoundingBoxSize(), boundingBoxSize);
+        EXPECT_EQ(event.GetTimeRangeOfIonizationInVolume("gasVolume"), timeRange);
+    }
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+    event.BuildHitsColumns();
+
+    EXPECT_EQ(event.GetNumberOfHits(), 9);
+    EXPECT_EQ(event.GetNumberOfHits(gasVolumeID), 5);
+    EXPECT_EQ(event.GetNumberOfPhysicalHits(), 7);
+    EXPECT_DOUBLE_EQ(event.GetBoundingBoxSize(), TMath::Sqrt(19 * 19 + 2 * 2 + 3 * 3));
+    EXPECT_EQ(event.GetTimeRangeOfIonizationInVolume("gasVolume"), make_pair(2., 3.5));
+}
+
+TEST(TRestGeant4Event, HitsColumnsInvalidation) {
+    // modifying the tracks or hits drops the columns, they are never used out of date
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+
+    auto hits = event.GetTrackPointer(0)->GetHitsPointer();
+    event.BuildHitsColumns();
+    hits->AddG4Hit({30, 0, 0}, 1, 5, comptProcessID, gasVolumeID);
+    EXPECT_FALSE(event.HasHitsColumns());
+    EXPECT_EQ(event.GetNumberOfHits(), 10);
+
+    event.BuildHitsColumns();
+    hits->GetEnergyRef()[0] = 3;
+    EXPECT_FALSE(event.HasHitsColumns());
+
+    event.BuildHitsColumns();
+    event.GetTrackPointer(1)->RemoveHits();
+    EXPECT_FALSE(event.HasHitsColumns());
+    EXPECT_EQ(event.GetNumberOfHits(), 8);
+
+    event.BuildHitsColumns();
+    event.AddTrack(MakeTrack(6, 5, "e-", "compt", 10, {20, 0, 0}, 4));
+    EXPECT_FALSE(event.HasHitsColumns());
+
+    event.BuildHitsColumns();
+    event.ClearTracks();
+    EXPECT_FALSE(event.HasHitsColumns());
+}
+
+TEST(TRestGeant4Event, HitsColumnsOnRead) {
+    WriteRun(runFile);
+
+    TRestRun run(runFile.c_str());
+    TRestGeant4Event* event = new TRestGeant4Event();
+    run.SetInputEvent(event);
+    event->SetHitsColumnsOnRead();
+
+    const vector<size_t> numberOfHits = {9, 5};
+    for (int entry = 0; entry < run.GetEntries(); entry++) {
+        run.GetEntry(entry);
+        ASSERT_TRUE(event->HasHitsColumns());
+        EXPECT_EQ(event->GetHitsColumns().GetNumberOfTracks(), event->GetNumberOfTracks());
+        EXPECT_EQ(event->GetNumberOfHits(), numberOfHits[entry]);
+    }
+
+    delete event;
+}
+
+TEST(TRestGeant4Event, EnergyInVolumeIndex) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume(gasVolumeID), 732);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume(vesselVolumeID), 50);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume(shieldingVolumeID), 10);
+    EXPECT_EQ(event.GetEnergyInVolume(-1), 0);
+    EXPECT_EQ(event.GetEnergyInVolume(100), 0);
+
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume("gasVolume"), 732);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume("vesselVolume"), 50);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume("shieldingVolume"), 10);
+    EXPECT_EQ(event.GetEnergyInVolume("unknownVolume"), 0);
+
+    for (const auto& [volumeName, energy] : event.GetEnergyInVolumeMap()) {
+        EXPECT_DOUBLE_EQ(event.GetEnergyInVolume(volumeName), energy);
+    }
+
+    // a new deposit must be seen by the following queries
+    event.AddEnergyInVolumeForParticleForProcess(8, vesselVolumeID, gammaID, comptProcessID);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume(vesselVolumeID), 58);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume("vesselVolume"), 58);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolume(gasVolumeID), 732);
+
+    event.Initialize();
+    EXPECT_EQ(event.GetEnergyInVolume(gasVolumeID), 0);
+}
+
+TEST(TRestGeant4Event, LegacyEnergyDeposits) {
+    // files written before version 10 keep the deposits keyed by name, they are translated into IDs on read
+    const auto legacyRunFile = fs::temp_directory_path() / "TRestGeant4EventLegacyTest.root";
+
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestRun writer;
+    writer.SetOutputFileName(legacyRunFile);
+    writer.AddMetadata(&metadata);
+    writer.FormOutputFile();
+
+    // without metadata the names cannot be translated, as in the old versions of restG4
+    TRestGeant4Event event;
+    writer.AddEventBranch(&event);
+    event.Initialize();
+    event.SetID(0);
+    event.AddEnergyInVolumeForParticleForProcess(30, "gasVolume", "gamma", "compt");
+    event.AddEnergyInVolumeForParticleForProcess(300, "gasVolume", "e-", "eIoni");
+    event.AddEnergyInVolumeForParticleForProcess(400, "gasVolume", "e-", "eIoni");
+    event.AddEnergyInVolumeForParticleForProcess(50, "vesselVolume", "e-", "eIoni");
+    EXPECT_EQ(event.GetNumberOfEnergyDeposits(), 0);
+    writer.GetEventTree()->Fill();
+
+    event.Initialize();
+    event.SetID(1);
+    event.AddEnergyInVolumeForParticleForProcess(5, "gasVolume", "gamma", "compt");
+    event.AddEnergyInVolumeForParticleForProcess(7, "unknownVolume", "gamma", "compt");
+    writer.GetEventTree()->Fill();
+
+    writer.UpdateOutputFile();
+    writer.CloseFile();
+
+    TRestRun run(legacyRunFile.c_str());
+    TRestGeant4Event* readEvent = new TRestGeant4Event();
+    run.SetInputEvent(readEvent);
+
+    run.GetEntry(0);
+    ASSERT_EQ(readEvent->GetNumberOfEnergyDeposits(), 3);
+    map<tuple<Int_t, Int_t, Int_t>, Double_t> deposits;
+    for (size_t n = 0; n < readEvent->GetNumberOfEnergyDeposits(); n++) {
+        deposits[{readEvent->GetEnergyDepositVolumeID(n), readEvent->GetEnergyDepositParticleID(n),
+                  readEvent->GetEnergyDepositProcessID(n)}] = readEvent->GetEnergyDeposit(n);
+    }
+    const map<tuple<Int_t, Int_t, Int_t>, Double_t> expectedDeposits = {
+        {{gasVolumeID, gammaID, comptProcessID}, 30},
+        {{gasVolumeID, electronID, eIoniProcessID}, 700},
+        {{vesselVolumeID, electronID, eIoniProcessID}, 50}};
+    EXPECT_EQ(deposits, expectedDeposits);
+    EXPECT_DOUBLE_EQ(readEvent->GetEnergyInVolume(gasVolumeID), 730);
+    EXPECT_DOUBLE_EQ(readEvent->GetEnergyInVolume("vesselVolume"), 50);
+
+    // the translated deposits keep accumulating in place
+    readEvent->AddEnergyInVolumeForParticleForProcess(10, "vesselVolume", "e-", "eIoni");
+    EXPECT_EQ(readEvent->GetNumberOfEnergyDeposits(), 3);
+    EXPECT_DOUBLE_EQ(readEvent->GetEnergyInVolume(vesselVolumeID), 60);
+
+    // an unknown name keeps all the deposits of the event keyed by name
+    run.GetEntry(1);
+    EXPECT_EQ(readEvent->GetNumberOfEnergyDeposits(), 0);
+    EXPECT_DOUBLE_EQ(readEvent->GetEnergyInVolume("gasVolume"), 5);
+    EXPECT_DOUBLE_EQ(readEvent->GetEnergyInVolume("unknownVolume"), 7);
+
+    // and the previous entry must not leave anything behind
+    run.GetEntry(0);
+    EXPECT_EQ(readEvent->GetNumberOfEnergyDeposits(), 3);
+    EXPECT_DOUBLE_EQ(readEvent->GetEnergyInVolume(gasVolumeID), 730);
+    EXPECT_EQ(readEvent->GetEnergyInVolume("unknownVolume"), 0);
+
+    delete readEvent;
+}
+
+TEST(TRestGeant4Event, Genealogy) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    for (Int_t eventID = 0; eventID < numberOfEvents; eventID++) {
+        TRestGeant4Event event;
+        FillEvent(event, &metadata, eventID);
+        event.AddTrack(MakeTrack(10, 9, "e-", "compt", 1, {0, 0, 0}, 0));  // parent not stored, a root
+
+        // the ancestry must match following the parent IDs up, as it was done before the genealogy arrays
+        const auto isAncestor = [&event](size_t n, size_t ancestor) {
+            for (const TRestGeant4Track* track = &event.GetTrack(n); track != nullptr;
+                 track = event.GetTrackByID(track->GetParentID())) {
+                if (track == &event.GetTrack(ancestor)) {
+                    return true;
+                }
+                if (track->GetParentID() == track->GetTrackID()) {
+                    break;
+                }
+            }
+            return false;
+        };
+
+        const size_t numberOfTracks = event.GetNumberOfTracks();
+        for (size_t n = 0; n < numberOfTracks; n++) {
+            const TRestGeant4Track* parent = event.GetTrackByID(event.GetTrack(n).GetParentID());
+            EXPECT_EQ(event.GetParentTrackIndex(n), parent != nullptr ? parent - &event.GetTrack(0) : -1);
+            EXPECT_EQ(event.GetTracksInPreOrder()[event.GetTrackPreOrder(n)], Int_t(n));
+            EXPECT_LT(event.GetTrackPreOrder(n), event.GetTrackPostOrder(n));
+
+            Double_t subtreeGasEnergy = 0;
+            for (size_t ancestor = 0; ancestor < numberOfTracks; ancestor++) {
+                EXPECT_EQ(event.IsTrackInSubtree(n, ancestor), isAncestor(n, ancestor));
+            }
+            for (size_t descendant = 0; descendant < numberOfTracks; descendant++) {
+                if (isAncestor(descendant, n)) {
+                    subtreeGasEnergy += event.GetTrack(descendant).GetEnergyInVolume(gasVolumeID);
+                }
+            }
+            EXPECT_DOUBLE_EQ(event.GetEnergyInVolumeInSubtree(n, gasVolumeID), subtreeGasEnergy);
+        }
+    }
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+    const vector<Int_t> parents = {-1, 0, 0, 2};
+    const vector<Int_t> depths = {0, 1, 1, 2};
+    for (size_t n = 0; n < event.GetNumberOfTracks(); n++) {
+        EXPECT_EQ(event.GetParentTrackIndex(n), parents[n]);
+        EXPECT_EQ(event.GetTrackDepth(n), depths[n]);
+    }
+    EXPECT_EQ(event.GetTracksInPreOrder(), vector<Int_t>({0, 1, 2, 3}));
+    EXPECT_TRUE(event.IsTrackInSubtree(3, 0));
+    EXPECT_TRUE(event.IsTrackInSubtree(3, 2));
+    EXPECT_FALSE(event.IsTrackInSubtree(3, 1));
+    EXPECT_FALSE(event.IsTrackInSubtree(0, 2));
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolumeInSubtree(0, gasVolumeID), 732);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolumeInSubtree(2, gasVolumeID), 400);
+    EXPECT_DOUBLE_EQ(event.GetEnergyInVolumeInSubtree(2, shieldingVolumeID), 10);
+
+    // adding a track rebuilds the genealogy
+    event.AddTrack(MakeTrack(6, 5, "e-", "compt", 10, {20, 0, 0}, 4));
+    EXPECT_EQ(event.GetParentTrackIndex(4), 3);
+    EXPECT_EQ(event.GetTrackDepth(4), 3);
+    EXPECT_TRUE(event.IsTrackInSubtree(4, 2));
+}
+
+TEST(TRestGeant4Event, HitsView) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    for (Int_t eventID = 0; eventID < numberOfEvents; eventID++) {
+        TRestGeant4Event event;
+        FillEvent(event, &metadata, eventID);
+
+        for (Int_t volumeID : {-1, gasVolumeID, vesselVolumeID, shieldingVolumeID, 100}) {
+            // without energy and process filters the view has the same hits as the TRestHits copy
+            const TRestHits hits = event.GetHits(volumeID);
+            const auto view = event.GetHitsView(volumeID);
+            ASSERT_EQ(view.GetNumberOfHits(), hits.GetNumberOfHits());
+            EXPECT_DOUBLE_EQ(view.GetTotalEnergy(), hits.GetTotalEnergy());
+            size_t n = 0;
+            for (const auto& hit : view) {
+                EXPECT_EQ(hit.GetPosition(), TVector3(hits.GetX(n), hits.GetY(n), hits.GetZ(n)));
+                EXPECT_EQ(hit.GetEnergy(), hits.GetEnergy(n));
+                n++;
+            }
+
+            for (Double_t minEnergy : {0., 10., 100.}) {
+                for (Int_t processID : {-1, eIoniProcessID, comptProcessID}) {
+                    vector<pair<const TRestGeant4Track*, size_t>> expected;
+                    for (const auto& track : event.GetTracks()) {
+                        const auto& trackHits = track.GetHits();
+                        for (size_t hit = 0; hit < trackHits.GetNumberOfHits(); hit++) {
+                            if ((volumeID == -1 || trackHits.GetVolumeId(hit) == volumeID) &&
+                                trackHits.GetEnergy(hit) >= minEnergy &&
+                                (processID == -1 || trackHits.GetProcessId(hit) == processID)) {
+                                expected.emplace_back(&track, hit);
+                            }
+                        }
+                    }
+                    vector<pair<const TRestGeant4Track*, size_t>> found;
+                    for (const auto& hit : event.GetHitsView(volumeID, minEnergy, processID)) {
+                        found.emplace_back(&hit.GetTrack(), hit.GetHitIndex());
+                        EXPECT_EQ(hit.GetTime(), hit.GetTrack().GetHits().GetTime(hit.GetHitIndex()));
+                    }
+                    EXPECT_EQ(found, expected);
+                }
+            }
+        }
+    }
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+    EXPECT_EQ(event.GetHitsView().GetNumberOfHits(), 9);
+    EXPECT_EQ(event.GetHitsView(gasVolumeID).GetNumberOfHits(), 5);
+    EXPECT_DOUBLE_EQ(event.GetHitsView(gasVolumeID).GetTotalEnergy(), 732);
+    EXPECT_EQ(event.GetHitsView(-1, 100).GetNumberOfHits(), 3);
+    EXPECT_DOUBLE_EQ(event.GetHitsView(gasVolumeID, 0, eIoniProcessID).GetTotalEnergy(), 700);
+
+    // the deviation computed from the view must match the one computed from the copied hits
+    const TRestHits gasHits = event.GetHits(gasVolumeID);
+    const TVector3 meanPosition(2540. / 732, 660. / 732, 990. / 732);
+    TVector3 deviation(0, 0, 0);
+    for (size_t n = 0; n < gasHits.GetNumberOfHits(); n++) {
+        const TVector3 difference = meanPosition - gasHits.GetPosition(n);
+        deviation += gasHits.GetEnergy(n) * TVector3(difference.X() * difference.X(),
+                                                     difference.Y() * difference.Y(),
+                                                     difference.Z() * difference.Z());
+    }
+    deviation *= 1. / 732;
+    const TVector3 viewDeviation = event.GetPositionDeviationInVolume(gasVolumeID);
+    EXPECT_NEAR(viewDeviation.X(), deviation.X(), 1e-9);
+    EXPECT_NEAR(viewDeviation.Y(), deviation.Y(), 1e-9);
+    EXPECT_NEAR(viewDeviation.Z(), deviation.Z(), 1e-9);
+}
+
+TEST(TRestGeant4Event, Copy) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+    event.BuildHitsColumns();
+
+    // the copy has the same contents, and its tracks and hits refer to the copy
+    TRestGeant4Event copy(event);
+    copy.SetHitsColumnsOnRead();
+    TRestGeant4Event assigned;
+    assigned.SetHitsColumnsOnRead();
+    assigned = event;
+    for (const TRestGeant4Event* eventCopy : {&copy, &assigned}) {
+        EXPECT_EQ(eventCopy->GetID(), event.GetID());
+        ASSERT_EQ(eventCopy->GetNumberOfTracks(), event.GetNumberOfTracks());
+        ExpectSameHits(eventCopy->GetHits(), event.GetHits());
+        EXPECT_EQ(eventCopy->GetNumberOfHits(gasVolumeID), 5);
+        EXPECT_DOUBLE_EQ(eventCopy->GetEnergyInVolume(gasVolumeID), 732);
+        EXPECT_EQ(eventCopy->GetTrackByID(5), &eventCopy->GetTrack(3));
+        EXPECT_EQ(eventCopy->GetParentTrackIndex(3), 2);
+        EXPECT_TRUE(eventCopy->HasHitsColumns());
+        for (const auto& track : eventCopy->GetTracks()) {
+            EXPECT_EQ(track.GetEvent(), eventCopy);
+            EXPECT_EQ(track.GetHits().GetTrack(), &track);
+            EXPECT_EQ(track.GetHits().GetEvent(), eventCopy);
+        }
+        // the read settings belong to the event object, they are not copied
+        EXPECT_TRUE(eventCopy->IsHitsColumnsOnRead());
+    }
+
+    // modifying the copy leaves the original untouched
+    copy.GetTrackPointer(0)->GetHitsPointer()->AddG4Hit({30, 0, 0}, 1, 5, comptProcessID, gasVolumeID);
+    EXPECT_FALSE(copy.HasHitsColumns());
+    EXPECT_TRUE(event.HasHitsColumns());
+    EXPECT_EQ(copy.GetNumberOfHits(), 10);
+    EXPECT_EQ(event.GetNumberOfHits(), 9);
+}
+
+TEST(TRestGeant4Event, CopyLazilyLoadedEvent) {
+    // a copy of a lazily loaded event must contain the hits of the entry
+    WriteRun(runFile);
+
+    vector<size_t> numberOfHits;
+    {
+        TRestRun run(runFile.c_str());
+        TRestGeant4Event* event = new TRestGeant4Event();
+        run.SetInputEvent(event);
+        for (int entry = 0; entry < run.GetEntries(); entry++) {
+            run.GetEntry(entry);
+            numberOfHits.push_back(event->GetNumberOfHits());
+        }
+        delete event;
+    }
+    EXPECT_EQ(numberOfHits, vector<size_t>({9, 5}));
+
+    TRestRun run(runFile.c_str());
+    TRestGeant4Event* event = new TRestGeant4Event();
+    run.SetInputEvent(event);
+    event->SetHitsLazyLoading();
+
+    TRestGeant4Event copy;
+    for (int entry = 0; entry < run.GetEntries(); entry++) {
+        run.GetEntry(entry);
+        copy = *event;
+        EXPECT_FALSE(copy.IsHitsLazyLoading());
+        EXPECT_EQ(copy.GetNumberOfHits(), numberOfHits[entry]);
+        for (const auto& track : copy.GetTracks()) {
+            EXPECT_EQ(track.GetEvent(), &copy);
+        }
+        // the hits of the lazily loaded event are still there after copying it
+        EXPECT_EQ(event->GetNumberOfHits(), numberOfHits[entry]);
+    }
+
+    delete event;
+}
+
+TEST(TRestGeant4Event, ParticleQueries) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+
+    EXPECT_EQ(event.GetNumberOfTracksForParticle("gamma"), 2);
+    EXPECT_EQ(event.GetNumberOfTracksForParticle(electronID), 2);
+    EXPECT_DOUBLE_EQ(event.GetEnergyDepositedByParticle("gamma"), 42);
+    EXPECT_DOUBLE_EQ(event.GetEnergyDepositedByParticle(electronID), 750);
+    EXPECT_TRUE(event.ContainsParticle("e-"));
+    EXPECT_FALSE(event.ContainsParticle(neutronID));
+    EXPECT_TRUE(event.ContainsParticleInVolume("gamma", shieldingVolumeID));
+    EXPECT_FALSE(event.ContainsParticleInVolume(electronID, shieldingVolumeID));
+
+    // unknown particles match no track, by name or by (negative) ID
+    EXPECT_EQ(event.GetNumberOfTracksForParticle("unknownParticle"), 0);
+    EXPECT_EQ(event.GetNumberOfTracksForParticle(-1), 0);
+    EXPECT_EQ(event.GetEnergyDepositedByParticle("unknownParticle"), 0);
+    EXPECT_EQ(event.GetEnergyDepositedByParticle(-1), 0);
+    EXPECT_FALSE(event.ContainsParticle("unknownParticle"));
+    EXPECT_FALSE(event.ContainsParticle(-1));
+    EXPECT_FALSE(event.ContainsParticleInVolume("unknownParticle"));
+    EXPECT_FALSE(event.ContainsParticleInVolume(-1));
+
+    // without metadata the tracks have no particle IDs (-1): an ID query must not match all of them
+    TRestGeant4Event eventWithoutMetadata;
+    FillEvent(eventWithoutMetadata, nullptr);
+    EXPECT_EQ(eventWithoutMetadata.GetTrack(0).GetParticleID(), -1);
+    EXPECT_EQ(eventWithoutMetadata.GetNumberOfTracksForParticle(-1), 0);
+    EXPECT_EQ(eventWithoutMetadata.GetEnergyDepositedByParticle(-1), 0);
+    EXPECT_FALSE(eventWithoutMetadata.ContainsParticle(-1));
+    EXPECT_FALSE(eventWithoutMetadata.ContainsParticleInVolume(-1, gasVolumeID));
+    EXPECT_EQ(eventWithoutMetadata.GetNumberOfTracksForParticle("gamma"), 2);
+    EXPECT_DOUBLE_EQ(eventWithoutMetadata.GetEnergyDepositedByParticle("e-"), 750);
+}
+
+TEST(TRestGeant4Event, ProcessOccurrences) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    // the hits of a process, found by scanning all the hits as the processes did before the index
+    const auto scanHits = [](const TRestGeant4Event& event, Int_t processID) {
+        vector<pair<Int_t, Int_t>> occurrences;
+        for (size_t trackIndex = 0; trackIndex < event.GetNumberOfTracks(); trackIndex++) {
+            const auto& hits = event.GetTrack(trackIndex).GetHits();
+            for (size_t n = 0; n < hits.GetNumberOfHits(); n++) {
+                if (hits.GetProcessId(n) == processID) {
+                    occurrences.emplace_back(trackIndex, n);
+                }
+            }
+        }
+        return occurrences;
+    };
+    const auto indexedHits = [](const TRestGeant4Event& event, Int_t processID) {
+        const auto occurrences = event.GetProcessOccurrences(processID);
+        return vector<pair<Int_t, Int_t>>(occurrences.begin(), occurrences.end());
+    };
+
+    const vector<Int_t> processIDs = {initProcessID, transportationProcessID, eIoniProcessID, eBremProcessID,
+                                      photProcessID, comptProcessID, nCaptureProcessID, -1, 1000};
+
+    TRestGeant4Event event;
+    for (Int_t eventID = 0; eventID < numberOfEvents; eventID++) {
+        FillEvent(event, &metadata, eventID);
+        for (const auto processID : processIDs) {
+            EXPECT_EQ(indexedHits(event, processID), scanHits(event, processID));
+        }
+    }
+
+    const vector<pair<Int_t, Int_t>> captures = {{0, 1}};
+    EXPECT_EQ(indexedHits(event, nCaptureProcessID), captures);
+    const vector<pair<Int_t, Int_t>> comptonHits = {{1, 1}};
+    EXPECT_EQ(indexedHits(event, comptProcessID), comptonHits);
+    EXPECT_TRUE(event.GetProcessOccurrences(photProcessID).empty());
+
+    // adding a track drops the index
+    auto track = MakeTrack(4, 1, "gamma", "nCapture", 100, {0, 0, -120}, 10);
+    track.GetHitsPointer()->AddG4Hit({0, 0, -100}, 0, 11, photProcessID, shieldingVolumeID);
+    event.AddTrack(track);
+    const vector<pair<Int_t, Int_t>> photoelectricHits = {{3, 0}};
+    EXPECT_EQ(indexedHits(event, photProcessID), photoelectricHits);
+    EXPECT_EQ(indexedHits(event, photProcessID), scanHits(event, photProcessID));
+
+    event.ClearTracks();
+    for (const auto processID : processIDs) {
+        EXPECT_TRUE(event.GetProcessOccurrences(processID).empty());
+    }
+}
+
+TEST(TRestGeant4Event, EnergyInSpheres) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    TRestGeant4Event event;
+    FillEvent(event, &metadata);
+
+    // squared distances to (5, 0, 0) of the hits with energy: 0, 22, 29, 49 and 225, the radii 7 and 15 are
+    // exactly at the distance of a hit, which must be left out as in GetEnergyInSphere
+    const vector<Double_t> radii = {15, 7, 0, 5, 7, 7.001, 100};
+    const vector<Double_t> expected = {782, 732, 0, 602, 732, 782, 792};
+
+    for (Int_t volumeID : {-1, gasVolumeID, vesselVolumeID, shieldingVolumeID}) {
+        const auto view = event.GetHitsView(volumeID);
+        const auto energies = view.GetEnergyInSpheres(5, 0, 0, radii);
+        ASSERT_EQ(energies.size(), radii.size());
+        for (size_t n = 0; n < radii.size(); n++) {
+            EXPECT_DOUBLE_EQ(energies[n], view.GetEnergyInSphere(5, 0, 0, radii[n]));
+            if (volumeID == -1) {
+                EXPECT_DOUBLE_EQ(energies[n], expected[n]);
+            }
+        }
+    }
+
+    EXPECT_TRUE(event.GetHitsView().GetEnergyInSpheres(5, 0, 0, {}).empty());
+}
@@ -0,0 +1,146 @@
+#include <TRestGeant4Event.h>
+#include <TRestGeant4Hits.h>
+#include <TRestGeant4Metadata.h>
+#include <gtest/gtest.h>
+
+#include "Geant4TestEvents.h"
+
+using namespace std;
+using namespace Geant4TestEvents;
+
+namespace {
+/// Maximum angle between a direction and its octahedral encoding (measured 6.45e-5 rad)
+constexpr Double_t maxDirectionError = 6.5e-5;
+
+/// Directions spread uniformly over the sphere (Fibonacci lattice), plus the axes and the octahedron edges
+vector<TVector3> GetTestDirections(size_t numberOfDirections = 100000) {
+    vector<TVector3> directions;
+    const Double_t goldenAngle = TMath::Pi() * (3 - TMath::Sqrt(5));
+    for (size_t n = 0; n < numberOfDirections; n++) {
+        const Double_t z = 1 - 2 * (n + 0.5) / numberOfDirections;
+        const Double_t radius = TMath::Sqrt(1 - z * z);
+        const Double_t phi = goldenAngle * n;
+        directions.emplace_back(radius * TMath::Cos(phi), radius * TMath::Sin(phi), z);
+    }
+    for (const TVector3& axis : {TVector3(1, 0, 0), TVector3(0, 1, 0), TVector3(0, 0, 1)}) {
+        directions.push_back(axis);
+        directions.push_back(-axis);
+    }
+    for (Double_t x : {-1., 1.}) {
+        for (Double_t y : {-1., 1.}) {
+            directions.push_back(TVector3(x, y, 0).Unit());
+            directions.push_back(TVector3(x, 0, y).Unit());
+            directions.push_back(TVector3(0, x, y).Unit());
+        }
+    }
+    return directions;
+}
+
+void ExpectSameHits(const TRestGeant4Hits& hits, const TRestGeant4Hits& expected) {
+    ASSERT_EQ(hits.GetNumberOfHits(), expected.GetNumberOfHits());
+    for (size_t n = 0; n < expected.GetNumberOfHits(); n++) {
+        EXPECT_EQ(hits.GetX(n), expected.GetX(n));
+        EXPECT_EQ(hits.GetY(n), expected.GetY(n));
+        EXPECT_EQ(hits.GetZ(n), expected.GetZ(n));
+        EXPECT_EQ(hits.GetTime(n), expected.GetTime(n));
+        EXPECT_EQ(hits.GetEnergy(n), expected.GetEnergy(n));
+        EXPECT_EQ(hits.GetKineticEnergy(n), expected.GetKineticEnergy(n));
+        EXPECT_EQ(hits.GetProcessId(n), expected.GetProcessId(n));
+        EXPECT_EQ(hits.GetVolumeId(n), expected.GetVolumeId(n));
+        EXPECT_LT(hits.GetMomentumDirection(n).Angle(expected.GetMomentumDirection(n)), maxDirectionError);
+    }
+}
+
+TRestGeant4Hits MakeHits() {
+    TRestGeant4Hits hits;
+    const auto directions = GetTestDirections(1000);
+    for (size_t n = 0; n < directions.size(); n++) {
+        // positions and times with few significant bits, kept exactly at full float precision
+        hits.AddG4Hit({n * 0.5, -(n * 0.25), 100. + n}, 1 + n % 7, n * 0.125, Int_t(n % 200),
+                      Int_t(n % 50), n * 2., directions[n]);
+    }
+    return hits;
+}
+}  // namespace
+
+TEST(TRestGeant4Hits, DirectionEncoding) {
+    Double_t maxError = 0;
+    for (const auto& direction : GetTestDirections()) {
+        UShort_t u, v;
+        TRestGeant4Hits::EncodeDirection(direction, u, v);
+        const TVector3 decoded = TRestGeant4Hits::DecodeDirection(u, v);
+        EXPECT_NEAR(decoded.Mag(), 1, 1e-12);
+        maxError = TMath::Max(maxError, decoded.Angle(direction));
+    }
+    EXPECT_LT(maxError, maxDirectionError);
+
+    // the direction does not need to be normalized
+    UShort_t u, v;
+    TRestGeant4Hits::EncodeDirection({0, 0, -5}, u, v);
+    EXPECT_EQ(TRestGeant4Hits::DecodeDirection(u, v), TVector3(0, 0, -1));
+
+    TRestGeant4Hits::EncodeDirection({0, 0, 0}, u, v);
+    EXPECT_EQ(u, 0);
+    EXPECT_EQ(v, 0);
+    EXPECT_EQ(TRestGeant4Hits::DecodeDirection(u, v), TVector3(0, 0, 0));
+}
+
+TEST(TRestGeant4Hits, CompactExpand) {
+    const TRestGeant4Hits hits = MakeHits();
+
+    TRestGeant4Hits compactHits = hits;
+    ASSERT_FALSE(compactHits.IsCompact());
+    ASSERT_TRUE(compactHits.Compact());
+    ASSERT_TRUE(compactHits.IsCompact());
+    ExpectSameHits(compactHits, hits);
+    EXPECT_DOUBLE_EQ(compactHits.GetEnergyInVolume(7), hits.GetEnergyInVolume(7));
+
+    compactHits.Expand();
+    EXPECT_FALSE(compactHits.IsCompact());
+    ExpectSameHits(compactHits, hits);
+
+    // adding a hit to compact hits expands them first
+    ASSERT_TRUE(compactHits.Compact());
+    compactHits.AddG4Hit({1, 2, 3}, 4, 5, 6, 7, 8, {0, 1, 0});
+    EXPECT_FALSE(compactHits.IsCompact());
+    ASSERT_EQ(compactHits.GetNumberOfHits(), hits.GetNumberOfHits() + 1);
+    const size_t last = hits.GetNumberOfHits();
+    EXPECT_EQ(compactHits.GetProcessId(last), 6);
+    EXPECT_EQ(compactHits.GetVolumeId(last), 7);
+    EXPECT_EQ(compactHits.GetMomentumDirection(last), TVector3(0, 1, 0));
+    EXPECT_EQ(compactHits.GetProcessId(last - 1), hits.GetProcessId(last - 1));
+
+    // IDs which do not fit in 16 bits leave the hits unchanged
+    TRestGeant4Hits largeIDHits = hits;
+    largeIDHits.AddG4Hit({0, 0, 0}, 1, 0, 0x10000, 0);
+    EXPECT_FALSE(largeIDHits.Compact());
+    EXPECT_FALSE(largeIDHits.IsCompact());
+    EXPECT_EQ(largeIDHits.GetProcessId(last), 0x10000);
+}
+
+TEST(TRestGeant4Hits, CompactEvent) {
+    TRestGeant4Metadata metadata;
+    FillMetadata(metadata);
+
+    for (Int_t eventID = 0; eventID < numberOfEvents; eventID++) {
+        TRestGeant4Event event;
+        FillEvent(event, &metadata, eventID);
+        TRestGeant4Event compactEvent = event;
+        ASSERT_TRUE(compactEvent.CompactHits());
+
+        ASSERT_EQ(compactEvent.GetNumberOfTracks(), event.GetNumberOfTracks());
+        for (size_t n = 0; n < event.GetNumberOfTracks(); n++) {
+            EXPECT_TRUE(compactEvent.GetTrack(n).GetHits().IsCompact());
+            ExpectSameHits(compactEvent.GetTrack(n).GetHits(), event.GetTrack(n).GetHits());
+        }
+        for (Int_t volumeID : {gasVolumeID, vesselVolumeID, shieldingVolumeID}) {
+            EXPECT_EQ(compactEvent.GetNumberOfHits(volumeID), event.GetNumberOfHits(volumeID));
+            EXPECT_DOUBLE_EQ(compactEvent.GetEnergyInVolume(volumeID), event.GetEnergyInVolume(volumeID));
+            if (event.GetNumberOfHits(volumeID) > 0) {
+                EXPECT_EQ(compactEvent.GetMeanPositionInVolume(volumeID),
+                          event.GetMeanPositionInVolume(volumeID));
+            }
+        }
+        EXPECT_EQ(compactEvent.GetNumberOfPhysicalHits(), event.GetNumberOfPhysicalHits());
+    }
+}
@@ -1,8 +1,12 @@
 
 #include <TRestGeant4Metadata.h>
+#include <TRestStringHelper.h>
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
@@ -10,6 +14,7 @@ using namespace std;
 
 const auto filesPath = fs::path(__FILE__).parent_path().parent_path() / "files";
 const auto geant4MetadataRml = filesPath / "TRestGeant4Example.rml";
+const auto assembliesGdml = filesPath / "AssembliesGeometry.gdml";
 
 TEST(TRestGeant4Metadata, TestFiles) {
     cout << "Test files path: " << filesPath << endl;
@@ -21,6 +26,7 @@ TEST(TRestGeant4Metadata, TestFiles) {
 
     // All used files in this tests
     EXPECT_TRUE(fs::exists(geant4MetadataRml));
+    EXPECT_TRUE(fs::exists(assembliesGdml));
 }
 
 TEST(TRestGeant4Metadata, Default) {
@@ -49,3 +55,235 @@ TEST(TRestGeant4Metadata, FromRml) {
     EXPECT_TRUE(particleSource->GetParticleName() == "geantino");
     EXPECT_TRUE(particleSource->GetEnergyDistributionType() == "mono");
 }
+
+TEST(TRestGeant4GeometryInfo, AlternativePathFromGeant4Path) {
+    TRestGeant4GeometryInfo geometryInfo;
+    geometryInfo.fGeant4AssemblyImprintToGdmlNameMap = {{"av_1_impr_1", "micromegasRight"},
+                                                        {"av_1_impr_2", "micromegasLeft"},
+                                                        {"av_1_impr_12", "micromegasTop"},
+                                                        {"av_2_impr_1", "shielding_vessel"}};
+    geometryInfo.fGeant4AssemblyImprintToAssemblyLogicalNameMap = {{"micromegasRight", "micromegas"},
+                                                                   {"micromegasLeft", "micromegas"},
+                                                                   {"micromegasTop", "micromegas"}};
+    geometryInfo.fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap = {
+        {"micromegas", {{"mMBaseLV_pv_0", "mMBase"}, {"mMBaseClosingBracketLV_pv_1", "mMBracket"}}}};
+
+    // former implementation, one replacement per map entry
+    const auto reference = [&geometryInfo](const TString& geant4Path) {
+        const TString separator = geometryInfo.GetPathSeparator();
+        string convertedPath = geant4Path.Data();
+        for (const auto& [gvName, gdmlName] : geometryInfo.fGeant4AssemblyImprintToGdmlNameMap) {
+            convertedPath = Replace(convertedPath, (gvName + "_").Data(), (gdmlName + separator).Data());
+        }
+        for (const auto& [gvImprint, assemblyLogicalName] :
+             geometryInfo.fGeant4AssemblyImprintToAssemblyLogicalNameMap) {
+            if (convertedPath.find(gvImprint.Data()) == string::npos) {
+                continue;
+            }
+            for (const auto& [childGeant4Name, childGdmlName] :
+                 geometryInfo.fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap.at(assemblyLogicalName)) {
+                convertedPath = Replace(convertedPath, (gvImprint + separator + childGeant4Name).Data(),
+                                        (gvImprint + separator + childGdmlName).Data());
+            }
+        }
+        return TString(convertedPath);
+    };
+
+    const vector<TString> paths = {"av_1_impr_1_mMBaseLV_pv_0",
+                                   "av_1_impr_2_mMBaseClosingBracketLV_pv_1",
+                                   "av_1_impr_12_mMBaseLV_pv_0",
+                                   "av_2_impr_1_vesselLV_pv_3",
+                                   "world_av_1_impr_2_mMBaseLV_pv_0",
+                                   "gasVolume",
+                                   ""};
+    // twice, the second time the memoized translations are used
+    for (int i = 0; i < 2; i++) {
+        for (const auto& path : paths) {
+            EXPECT_EQ(geometryInfo.GetAlternativePathFromGeant4Path(path), reference(path)) << path;
+        }
+    }
+    EXPECT_EQ(geometryInfo.GetAlternativePathFromGeant4Path("av_1_impr_2_mMBaseLV_pv_0"),
+              "micromegasLeft_mMBase");
+
+    // changing an existing entry of the maps requires invalidating the translators and the memo
+    geometryInfo.fGeant4AssemblyImprintToGdmlNameMap["av_1_impr_2"] = "micromegasBottom";
+    geometryInfo.fGeant4AssemblyImprintToAssemblyLogicalNameMap.erase("micromegasLeft");
+    geometryInfo.fGeant4AssemblyImprintToAssemblyLogicalNameMap["micromegasBottom"] = "micromegas";
+    geometryInfo.InvalidateIndices();
+    EXPECT_EQ(geometryInfo.GetAlternativePathFromGeant4Path("av_1_impr_2_mMBaseLV_pv_0"),
+              "micromegasBottom_mMBase");
+}
+
+TEST(TRestGeant4GeometryInfo, PopulateFromGdml) {
+    TRestGeant4GeometryInfo geometryInfo;
+    geometryInfo.PopulateFromGdml(assembliesGdml.c_str());
+
+    // tables built by the former implementation (one DOM walk per table) from the same file
+    const vector<TString> physicalNames = {
+        "shielding_vessel_gas",
+        "shielding_veto_scintillator",
+        "shielding_veto_lightGuide",
+        "vetoLayerTop_vetoA_scintillator",
+        "vetoLayerTop_vetoA_lightGuide",
+        "vetoLayerTop_vetoB_scintillator",
+        "vetoLayerTop_vetoB_lightGuide",
+        "vetoLayerBottom_vetoA_scintillator",
+        "vetoLayerBottom_vetoA_lightGuide",
+        "vetoLayerBottom_vetoB_scintillator",
+        "vetoLayerBottom_vetoB_lightGuide"};
+    const vector<TString> logicalNames = {"gasVolume",          "scintillatorVolume", "lightGuideVolume",
+                                          "scintillatorVolume", "lightGuideVolume",   "scintillatorVolume",
+                                          "lightGuideVolume",   "scintillatorVolume", "lightGuideVolume",
+                                          "scintillatorVolume", "lightGuideVolume"};
+    const map<TString, TString> imprintToGdmlName = {{"av_1_impr_1", "veto"},
+                                                     {"av_2_impr_1", "vetoLayerTop"},
+                                                     {"av_2_impr_2", "vetoLayerTop_vetoA"},
+                                                     {"av_2_impr_3", "vetoLayerTop_vetoB"},
+                                                     {"av_2_impr_4", "vetoLayerBottom"},
+                                                     {"av_2_impr_5", "vetoLayerBottom_vetoA"},
+                                                     {"av_2_impr_6", "vetoLayerBottom_vetoB"}};
+    const map<TString, map<TString, TString>> assemblyChildren = {
+        {"vetoAssembly",
+         {{"scintillatorVolume_pv_0", "scintillator"}, {"lightGuideVolume_pv_1", "lightGuide"}}},
+        {"vetoLayerAssembly", {{"vetoAssembly_pv_0", "vetoA"}, {"vetoAssembly_pv_1", "vetoB"}}}};
+    const map<TString, TString> imprintToAssemblyLogicalName = {{"veto", "vetoAssembly"},
+                                                                {"vetoA", "vetoAssembly"},
+                                                                {"vetoB", "vetoAssembly"},
+                                                                {"vetoLayerTop", "vetoLayerAssembly"},
+                                                                {"vetoLayerBottom", "vetoLayerAssembly"}};
+
+    EXPECT_EQ(geometryInfo.fGdmlNewPhysicalNames, physicalNames);
+    EXPECT_EQ(geometryInfo.fGdmlLogicalNames, logicalNames);
+    EXPECT_EQ(geometryInfo.fGeant4AssemblyImprintToGdmlNameMap, imprintToGdmlName);
+    EXPECT_EQ(geometryInfo.fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap, assemblyChildren);
+    EXPECT_EQ(geometryInfo.fGeant4AssemblyImprintToAssemblyLogicalNameMap, imprintToAssemblyLogicalName);
+
+    EXPECT_EQ(geometryInfo.GetAlternativePathFromGeant4Path("av_2_impr_5_lightGuideVolume_pv_1"),
+              "vetoLayerBottom_vetoA_lightGuide");
+}
+
+TEST(TRestGeant4GeometryInfo, GdmlCache) {
+    const auto testPath = fs::temp_directory_path() / "TRestGeant4GeometryInfoGdmlCache";
+    fs::remove_all(testPath);
+    fs::create_directories(testPath);
+    const auto gdmlFile = testPath / "geometry.gdml";
+    fs::copy_file(assembliesGdml, gdmlFile);
+    const auto cachePath = testPath / "cache";
+
+    const auto cacheFiles = [&cachePath]() {
+        vector<fs::path> files;
+        if (fs::is_directory(cachePath)) {
+            for (const auto& entry : fs::directory_iterator(cachePath)) {
+                files.push_back(entry.path());
+            }
+        }
+        return files;
+    };
+    const auto expectSameTables = [](const TRestGeant4GeometryInfo& info,
+                                     const TRestGeant4GeometryInfo& expected) {
+        EXPECT_EQ(info.fGdmlNewPhysicalNames, expected.fGdmlNewPhysicalNames);
+        EXPECT_EQ(info.fGdmlLogicalNames, expected.fGdmlLogicalNames);
+        EXPECT_EQ(info.fGeant4AssemblyImprintToGdmlNameMap, expected.fGeant4AssemblyImprintToGdmlNameMap);
+        EXPECT_EQ(info.fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap,
+                  expected.fGdmlAssemblyToChildrenGeant4ToGdmlPhysicalNameMap);
+        EXPECT_EQ(info.fGeant4AssemblyImprintToAssemblyLogicalNameMap,
+                  expected.fGeant4AssemblyImprintToAssemblyLogicalNameMap);
+    };
+
+    // the cache is disabled by default
+    unsetenv("REST_GEANT4_GEOMETRY_CACHE");
+    TRestGeant4GeometryInfo reference;
+    reference.PopulateFromGdml(gdmlFile.c_str());
+    EXPECT_FALSE(fs::exists(cachePath));
+
+    setenv("REST_GEANT4_GEOMETRY_CACHE", cachePath.c_str(), 1);
+
+    // miss, the GDML is parsed and the cache file written
+    TRestGeant4GeometryInfo miss;
+    miss.PopulateFromGdml(gdmlFile.c_str());
+    expectSameTables(miss, reference);
+    ASSERT_EQ(cacheFiles().size(), 1);
+    const auto cacheFile = cacheFiles().front();
+    const auto cacheWriteTime = fs::last_write_time(cacheFile);
+
+    // hit, the tables are read from the cache file, which is not written again
+    TRestGeant4GeometryInfo hit;
+    hit.PopulateFromGdml(gdmlFile.c_str());
+    expectSameTables(hit, reference);
+    ASSERT_EQ(cacheFiles().size(), 1);
+    EXPECT_EQ(fs::last_write_time(cacheFile), cacheWriteTime);
+
+    // a change in the GDML gives another cache file, the former one is not used
+    stringstream contents;
+    contents << ifstream(gdmlFile).rdbuf();
+    const string gdml = Replace(contents.str(), "\"vetoLayerTop\"", "\"vetoLayerUp\"");
+    ASSERT_NE(gdml, contents.str());
+    ofstream(gdmlFile) << gdml;
+
+    TRestGeant4GeometryInfo changed;
+    changed.PopulateFromGdml(gdmlFile.c_str());
+    EXPECT_EQ(cacheFiles().size(), 2);
+    EXPECT_EQ(changed.fGdmlNewPhysicalNames.size(), reference.fGdmlNewPhysicalNames.size());
+    EXPECT_EQ(changed.fGdmlNewPhysicalNames[3], "vetoLayerUp_vetoA_scintillator");
+    EXPECT_EQ(changed.fGeant4AssemblyImprintToGdmlNameMap.at("av_2_impr_1"), "vetoLayerUp");
+    EXPECT_EQ(changed.fGeant4AssemblyImprintToAssemblyLogicalNameMap.count("vetoLayerTop"), 0);
+
+    TRestGeant4GeometryInfo changedHit;
+    changedHit.PopulateFromGdml(gdmlFile.c_str());
+    expectSameTables(changedHit, changed);
+    EXPECT_EQ(cacheFiles().size(), 2);
+
+    // a cache directory which cannot be created is silently skipped
+    setenv("REST_GEANT4_GEOMETRY_CACHE", (gdmlFile / "cache").c_str(), 1);
+    TRestGeant4GeometryInfo notWritable;
+    notWritable.PopulateFromGdml(gdmlFile.c_str());
+    expectSameTables(notWritable, changed);
+
+    unsetenv("REST_GEANT4_GEOMETRY_CACHE");
+    fs::remove_all(testPath);
+}
+
+TEST(TRestGeant4Metadata, ActiveVolumeIndex) {
+    TRestGeant4Metadata metadata;
+    metadata.SetActiveVolume("gasVolume", 1, 0.5);
+    metadata.SetActiveVolume("vesselVolume", 0.5, 2);
+    metadata.SetActiveVolume("GasVolume", 0.1, 3);
+    // an existing volume is updated, not added again
+    metadata.SetActiveVolume("vesselVolume", 0.25, 4);
+
+    ASSERT_EQ(metadata.GetNumberOfActiveVolumes(), 3);
+    EXPECT_EQ(metadata.GetActiveVolumeID("gasVolume"), 0);
+    EXPECT_EQ(metadata.GetActiveVolumeID("vesselVolume"), 1);
+    EXPECT_EQ(metadata.GetActiveVolumeID("GasVolume"), 2);
+    EXPECT_EQ(metadata.GetActiveVolumeID("shieldingVolume"), -1);
+    EXPECT_TRUE(metadata.isVolumeStored("vesselVolume"));
+    EXPECT_FALSE(metadata.isVolumeStored("VESSELVOLUME"));
+    EXPECT_DOUBLE_EQ(metadata.GetStorageChance("vesselVolume"), 0.25);
+    // the maximum step is looked up ignoring case, the first volume matching is used
+    EXPECT_DOUBLE_EQ(metadata.GetMaxStepSize("VESSELVOLUME"), 4);
+    EXPECT_DOUBLE_EQ(metadata.GetMaxStepSize("GASVOLUME"), 0.5);
+
+    // the index of a copy is rebuilt from its own volumes (the particle sources are not copied)
+    TRestGeant4Metadata copy(metadata);
+    TRestGeant4Metadata assigned;
+    assigned.SetActiveVolume("shieldingVolume", 1);
+    EXPECT_EQ(assigned.GetActiveVolumeID("shieldingVolume"), 0);
+    assigned = metadata;
+    for (const TRestGeant4Metadata* other : {&copy, &assigned}) {
+        ASSERT_EQ(other->GetNumberOfActiveVolumes(), 3);
+        for (unsigned int n = 0; n < other->GetNumberOfActiveVolumes(); n++) {
+            EXPECT_EQ(other->GetActiveVolumeID(other->GetActiveVolumeName(n)), Int_t(n));
+        }
+        EXPECT_EQ(other->GetActiveVolumeID("shieldingVolume"), -1);
+    }
+    EXPECT_DOUBLE_EQ(assigned.GetMaxStepSize("VESSELVOLUME"), 4);
+
+    // the copies do not share the index of the original
+    metadata.SetActiveVolume("shieldingVolume", 1);
+    EXPECT_EQ(metadata.GetActiveVolumeID("shieldingVolume"), 3);
+    EXPECT_EQ(copy.GetActiveVolumeID("shieldingVolume"), -1);
+    copy.SetActiveVolume("readoutVolume", 1);
+    EXPECT_EQ(copy.GetActiveVolumeID("readoutVolume"), 3);
+    EXPECT_EQ(metadata.GetActiveVolumeID("readoutVolume"), -1);
+    EXPECT_EQ(assigned.GetActiveVolumeID("readoutVolume"), -1);
+}